@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "EdgeGrid.h"
+#include "CompiledShape.h"
+#include "DoubleBatch.hpp"
+#include "FloatBatch.hpp"
+#include "edge-selectors.h"
+#include "contour-combiners.h"
+
+namespace msdfgen {
+
+/// Finds the distances between a CompiledShape and MSDFGEN_BATCH_SIZE points at once, evaluating each edge for all of them with the batch kernels. Yields the same results as ShapeDistanceFinder if Batch is DoubleBatch, or computes them in single precision if it is FloatBatch.
+template <class ContourCombiner, class Batch = DoubleBatch>
+class BatchShapeDistanceFinder {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    // Passed shape object must persist until the distance finder is destroyed!
+    explicit BatchShapeDistanceFinder(const CompiledShape &shape, const EdgeGrid *edgeGrid = NULL);
+    /// Finds the distances from MSDFGEN_BATCH_SIZE origins. Not thread-safe! Is fastest when subsequent queries are close together in each lane.
+    void distance(DistanceType *distances, const Point2 *origins);
+
+private:
+    typedef typename ContourCombiner::EdgeSelectorType EdgeSelector;
+
+    const CompiledShape &shape;
+    const EdgeGrid *edgeGrid;
+    std::vector<ContourCombiner> contourCombiners;
+    std::vector<typename EdgeSelector::EdgeCache> shapeEdgeCache;
+    std::vector<int> nearbyEdges;
+
+    void addEdge(EdgeSelector *const *edgeSelectors, int edgeIndex, const Point2 *origins, const Batch &x, const Batch &y);
+
+};
+
+}
+
+#include "BatchShapeDistanceFinder.hpp"
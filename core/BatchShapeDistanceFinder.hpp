@@ -0,0 +1,77 @@
+
+#include "BatchShapeDistanceFinder.h"
+
+#include "batch-signed-distance.hpp"
+
+namespace msdfgen {
+
+template <class ContourCombiner, class Batch>
+BatchShapeDistanceFinder<ContourCombiner, Batch>::BatchShapeDistanceFinder(const CompiledShape &shape, const EdgeGrid *edgeGrid) : shape(shape), edgeGrid(edgeGrid), contourCombiners(MSDFGEN_BATCH_SIZE, ContourCombiner(shape)), shapeEdgeCache(MSDFGEN_BATCH_SIZE*shape.edges.size()) { }
+
+template <class ContourCombiner, class Batch>
+void BatchShapeDistanceFinder<ContourCombiner, Batch>::distance(DistanceType *distances, const Point2 *origins) {
+    double x[MSDFGEN_BATCH_SIZE], y[MSDFGEN_BATCH_SIZE];
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+        contourCombiners[i].reset(origins[i]);
+        x[i] = origins[i].x, y[i] = origins[i].y;
+    }
+    Batch batchX = Batch::load(x), batchY = Batch::load(y);
+    int contourCount = shape.contourCount();
+
+    for (int i = 0; i < contourCount; ++i) {
+        int firstEdge = shape.contourOffsets[i], endEdge = shape.contourOffsets[i+1];
+        if (firstEdge < endEdge) {
+            EdgeSelector *edgeSelectors[MSDFGEN_BATCH_SIZE];
+            double searchRadii[MSDFGEN_BATCH_SIZE];
+            for (int j = 0; j < MSDFGEN_BATCH_SIZE; ++j) {
+                edgeSelectors[j] = &contourCombiners[j].edgeSelector(i);
+                searchRadii[j] = edgeSelectors[j]->searchRadius();
+            }
+            if (edgeGrid && edgeGrid->findEdges(nearbyEdges, i, origins, searchRadii, MSDFGEN_BATCH_SIZE)) {
+                for (std::vector<int>::const_iterator edge = nearbyEdges.begin(); edge != nearbyEdges.end(); ++edge)
+                    addEdge(edgeSelectors, firstEdge+*edge, origins, batchX, batchY);
+            } else {
+                for (int edge = firstEdge; edge < endEdge; ++edge)
+                    addEdge(edgeSelectors, edge, origins, batchX, batchY);
+            }
+        }
+    }
+
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        distances[i] = contourCombiners[i].distance();
+}
+
+template <class ContourCombiner, class Batch>
+void BatchShapeDistanceFinder<ContourCombiner, Batch>::addEdge(EdgeSelector *const *edgeSelectors, int edgeIndex, const Point2 *origins, const Batch &x, const Batch &y) {
+    typename EdgeSelector::EdgeCache *edgeCache = &shapeEdgeCache[MSDFGEN_BATCH_SIZE*edgeIndex];
+    int lanes = 0, laneCount = 0;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+        if (edgeSelectors[i]->isEdgeRelevant(edgeCache[i], shape, edgeIndex)) {
+            lanes |= 1<<i;
+            ++laneCount;
+        }
+    }
+    if (laneCount == 1 && Batch::scalarEquivalent) {
+        // A single lane is evaluated faster by the scalar kernel
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+            if (lanes&(1<<i)) {
+                double param;
+                SignedDistance distance = shape.signedDistance(edgeIndex, origins[i], param);
+                edgeSelectors[i]->addEdge(edgeCache[i], shape, edgeIndex, distance, param);
+            }
+        }
+    } else if (laneCount) {
+        Batch batchDistance, batchDot, batchParam;
+        batchSignedDistance(batchDistance, batchDot, batchParam, shape, edgeIndex, x, y, lanes);
+        double distance[MSDFGEN_BATCH_SIZE], dot[MSDFGEN_BATCH_SIZE], param[MSDFGEN_BATCH_SIZE];
+        batchDistance.store(distance);
+        batchDot.store(dot);
+        batchParam.store(param);
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+            if (lanes&(1<<i))
+                edgeSelectors[i]->addEdge(edgeCache[i], shape, edgeIndex, SignedDistance(distance[i], dot[i]), param[i]);
+        }
+    }
+}
+
+}
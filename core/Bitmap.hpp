@@ -17,7 +17,8 @@ Bitmap<T, N>::Bitmap(int width, int height) : w(width), h(height) {
 template <typename T, int N>
 Bitmap<T, N>::Bitmap(const BitmapConstRef<T, N> &orig) : w(orig.width), h(orig.height) {
     pixels = new T[N*w*h];
-    memcpy(pixels, orig.pixels, sizeof(T)*N*w*h);
+    for (int y = 0; y < h; ++y)
+        memcpy(pixels+N*w*y, orig(0, y), sizeof(T)*N*w);
 }
 
 template <typename T, int N>
@@ -41,11 +42,14 @@ Bitmap<T, N>::~Bitmap() {
 
 template <typename T, int N>
 Bitmap<T, N> & Bitmap<T, N>::operator=(const BitmapConstRef<T, N> &orig) {
-    if (pixels != orig.pixels) {
+    if (!(pixels == orig.pixels && w == orig.width && h == orig.height && orig.contiguous())) {
+        // The reference may point into the current pixels, which are therefore released only after they are copied
+        T *newPixels = new T[N*orig.width*orig.height];
+        for (int y = 0; y < orig.height; ++y)
+            memcpy(newPixels+N*orig.width*y, orig(0, y), sizeof(T)*N*orig.width);
         delete [] pixels;
+        pixels = newPixels;
         w = orig.width, h = orig.height;
-        pixels = new T[N*w*h];
-        memcpy(pixels, orig.pixels, sizeof(T)*N*w*h);
     }
     return *this;
 }
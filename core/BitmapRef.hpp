@@ -8,17 +8,36 @@ namespace msdfgen {
 typedef unsigned char byte;
 
 /// Reference to a 2D image bitmap or a buffer acting as one. Pixel storage not owned or managed by the object.
+/// Its rows may be spaced apart by more than their width, so that a part of a larger bitmap can be referenced, and ordered top-down with a negative row stride.
 template <typename T, int N = 1>
 struct BitmapRef {
 
     T *pixels;
     int width, height;
+    /// The offset between the starts of consecutive rows (y and y+1) in elements of T.
+    int rowStride;
 
-    inline BitmapRef() : pixels(NULL), width(0), height(0) { }
-    inline BitmapRef(T *pixels, int width, int height) : pixels(pixels), width(width), height(height) { }
+    inline BitmapRef() : pixels(NULL), width(0), height(0), rowStride(0) { }
+    inline BitmapRef(T *pixels, int width, int height) : pixels(pixels), width(width), height(height), rowStride(N*width) { }
+    inline BitmapRef(T *pixels, int width, int height, int rowStride) : pixels(pixels), width(width), height(height), rowStride(rowStride) { }
 
     inline T * operator()(int x, int y) const {
-        return pixels+N*(width*y+x);
+        return pixels+(rowStride*y+N*x);
+    }
+
+    /// Returns a reference to the rectangle of width x height pixels whose bottom left pixel is (x, y).
+    inline BitmapRef<T, N> section(int x, int y, int width, int height) const {
+        return BitmapRef<T, N>(operator()(x, y), width, height, rowStride);
+    }
+
+    /// Returns a reference to the same pixels with the order of rows reversed, e.g. to reference a top-down image buffer.
+    inline BitmapRef<T, N> flipped() const {
+        return BitmapRef<T, N>(height > 0 ? operator()(0, height-1) : pixels, width, height, -rowStride);
+    }
+
+    /// Returns true if the rows are stored consecutively without gaps from row 0 up, so the pixels may be accessed as a single array.
+    inline bool contiguous() const {
+        return rowStride == N*width;
     }
 
 };
@@ -29,13 +48,31 @@ struct BitmapConstRef {
 
     const T *pixels;
     int width, height;
+    /// The offset between the starts of consecutive rows (y and y+1) in elements of T.
+    int rowStride;
 
-    inline BitmapConstRef() : pixels(NULL), width(0), height(0) { }
-    inline BitmapConstRef(const T *pixels, int width, int height) : pixels(pixels), width(width), height(height) { }
-    inline BitmapConstRef(const BitmapRef<T, N> &orig) : pixels(orig.pixels), width(orig.width), height(orig.height) { }
+    inline BitmapConstRef() : pixels(NULL), width(0), height(0), rowStride(0) { }
+    inline BitmapConstRef(const T *pixels, int width, int height) : pixels(pixels), width(width), height(height), rowStride(N*width) { }
+    inline BitmapConstRef(const T *pixels, int width, int height, int rowStride) : pixels(pixels), width(width), height(height), rowStride(rowStride) { }
+    inline BitmapConstRef(const BitmapRef<T, N> &orig) : pixels(orig.pixels), width(orig.width), height(orig.height), rowStride(orig.rowStride) { }
 
     inline const T * operator()(int x, int y) const {
-        return pixels+N*(width*y+x);
+        return pixels+(rowStride*y+N*x);
+    }
+
+    /// Returns a reference to the rectangle of width x height pixels whose bottom left pixel is (x, y).
+    inline BitmapConstRef<T, N> section(int x, int y, int width, int height) const {
+        return BitmapConstRef<T, N>(operator()(x, y), width, height, rowStride);
+    }
+
+    /// Returns a reference to the same pixels with the order of rows reversed, e.g. to reference a top-down image buffer.
+    inline BitmapConstRef<T, N> flipped() const {
+        return BitmapConstRef<T, N>(height > 0 ? operator()(0, height-1) : pixels, width, height, -rowStride);
+    }
+
+    /// Returns true if the rows are stored consecutively without gaps from row 0 up, so the pixels may be accessed as a single array.
+    inline bool contiguous() const {
+        return rowStride == N*width;
     }
 
 };
@@ -0,0 +1,167 @@
+
+#include "CompiledShape.h"
+
+#include <cmath>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+static int compileLinearSegment(CompiledShape::LinearEdges &edges, const LinearSegment *segment) {
+    Vector2 ab = segment->p[1]-segment->p[0];
+    edges.p0.push_back(segment->p[0]);
+    edges.p1.push_back(segment->p[1]);
+    edges.ab.push_back(ab);
+    edges.orthonormal.push_back(ab.getOrthonormal(false));
+    edges.unitDirection.push_back(ab.normalize());
+    edges.abab.push_back(dotProduct(ab, ab));
+    return (int) edges.p0.size()-1;
+}
+
+static int compileQuadraticSegment(CompiledShape::QuadraticEdges &edges, const QuadraticSegment *segment) {
+    const Point2 *p = segment->p;
+    Vector2 ab = p[1]-p[0];
+    Vector2 br = p[2]-p[1]-ab;
+    Vector2 startDirection = segment->direction(0);
+    Vector2 endDirection = segment->direction(1);
+    edges.p0.push_back(p[0]);
+    edges.p1.push_back(p[1]);
+    edges.p2.push_back(p[2]);
+    edges.ab.push_back(ab);
+    edges.br.push_back(br);
+    edges.p12.push_back(p[2]-p[1]);
+    edges.p02.push_back(p[2]-p[0]);
+    edges.a.push_back(dotProduct(br, br));
+    edges.b.push_back(3*dotProduct(ab, br));
+    edges.c.push_back(2*dotProduct(ab, ab));
+    edges.startDirection.push_back(startDirection);
+    edges.endDirection.push_back(endDirection);
+    edges.startUnitDirection.push_back(startDirection.normalize());
+    edges.endUnitDirection.push_back(endDirection.normalize());
+    edges.startDirectionSquared.push_back(dotProduct(startDirection, startDirection));
+    edges.endDirectionSquared.push_back(dotProduct(endDirection, endDirection));
+    return (int) edges.p0.size()-1;
+}
+
+static void compileCubicPiece(CompiledShape::CubicPieces &pieces, Point2 p0, Point2 p1, Point2 p2, double deviation) {
+    Vector2 ab = p1-p0;
+    Vector2 br = p2-p1-ab;
+    Point2 center = 1./3*(p0+p1+p2);
+    pieces.p0.push_back(p0);
+    pieces.ab.push_back(ab);
+    pieces.br.push_back(br);
+    pieces.a.push_back(dotProduct(br, br));
+    pieces.b.push_back(3*dotProduct(ab, br));
+    pieces.c.push_back(2*dotProduct(ab, ab));
+    // The quadratic piece lies within the convex hull of its control points and the cubic one within deviation of it
+    pieces.center.push_back(center);
+    pieces.radius.push_back(max(max((p0-center).length(), (p1-center).length()), (p2-center).length())+deviation);
+}
+
+/// Splits a cubic segment into equal parameter intervals and approximates each with a quadratic curve. Returns the number of pieces.
+static int compileCubicPieces(CompiledShape::CubicPieces &pieces, const CubicSegment *segment, double tolerance) {
+    const Point2 *p = segment->p;
+    // A cubic curve deviates from the quadratic curve with control point (3*(p1+p2)-p0-p3)/4 by at most sqrt(3)/36*|p3-3*p2+3*p1-p0| at equal parameter values.
+    // The third difference is divided by n^3 for each of n equal subdivisions. The distance to the cubic curve at the parameter value of the nearest point
+    // of its approximation exceeds the exact distance by at most twice the deviation, which therefore must not exceed half of the tolerance.
+    double thirdDifference = ((p[3]-p[2])-2*(p[2]-p[1])+(p[1]-p[0])).length();
+    int pieceCount = 1;
+    while (pieceCount < MSDFGEN_CUBIC_MAX_PIECES && sqrt(3.)/36*thirdDifference > .5*tolerance*pieceCount*pieceCount*pieceCount)
+        ++pieceCount;
+    double deviation = sqrt(3.)/36*thirdDifference/(pieceCount*pieceCount*pieceCount);
+    Point2 start = p[0];
+    Vector2 startDirection = p[1]-p[0];
+    for (int i = 1; i <= pieceCount; ++i) {
+        double t = (double) i/pieceCount;
+        Point2 end = i == pieceCount ? p[3] : segment->point(t);
+        Vector2 endDirection = mix(mix(p[1]-p[0], p[2]-p[1], t), mix(p[2]-p[1], p[3]-p[2], t), t);
+        // Inner control points of the cubic piece, which are combined into the quadratic one
+        Point2 c1 = start+1./pieceCount*startDirection;
+        Point2 c2 = end-1./pieceCount*endDirection;
+        compileCubicPiece(pieces, start, .25*(3*(c1+c2)-start-end), end, deviation);
+        start = end;
+        startDirection = endDirection;
+    }
+    return pieceCount;
+}
+
+static int compileCubicSegment(CompiledShape::CubicEdges &edges, CompiledShape::CubicPieces &pieces, const CubicSegment *segment, double tolerance) {
+    const Point2 *p = segment->p;
+    Vector2 ab = p[1]-p[0];
+    Vector2 br = p[2]-p[1]-ab;
+    Vector2 startDirection = segment->direction(0);
+    Vector2 endDirection = segment->direction(1);
+    edges.p0.push_back(p[0]);
+    edges.p1.push_back(p[1]);
+    edges.p2.push_back(p[2]);
+    edges.p3.push_back(p[3]);
+    edges.ab.push_back(ab);
+    edges.br.push_back(br);
+    edges.as.push_back((p[3]-p[2])-(p[2]-p[1])-br);
+    edges.p12.push_back(p[2]-p[1]);
+    edges.p23.push_back(p[3]-p[2]);
+    edges.startDirection.push_back(startDirection);
+    edges.endDirection.push_back(endDirection);
+    edges.startUnitDirection.push_back(startDirection.normalize());
+    edges.endUnitDirection.push_back(endDirection.normalize());
+    edges.startDirectionSquared.push_back(dotProduct(startDirection, startDirection));
+    edges.endDirectionSquared.push_back(dotProduct(endDirection, endDirection));
+    edges.firstPiece.push_back((int) pieces.p0.size());
+    edges.pieceCount.push_back(tolerance > 0 ? compileCubicPieces(pieces, segment, tolerance) : 0);
+    return (int) edges.p0.size()-1;
+}
+
+CompiledShape::CompiledShape(const Shape &shape, double cubicTolerance) {
+    edges.reserve(shape.edgeCount());
+    contourOffsets.reserve(shape.contours.size()+1);
+    windings.reserve(shape.contours.size());
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        contourOffsets.push_back((int) edges.size());
+        windings.push_back(contour->winding());
+        if (contour->edges.empty())
+            continue;
+        // Each edge is stored along with the corners shared with its neighbors, starting with the last edge
+        const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+        const EdgeSegment *curEdge = contour->edges.back();
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            const EdgeSegment *nextEdge = *edge;
+            Edge compiledEdge;
+            compiledEdge.type = GENERIC_EDGE;
+            compiledEdge.index = -1;
+            compiledEdge.color = curEdge->color;
+            compiledEdge.segment = curEdge;
+            compiledEdge.point[0] = curEdge->point(0);
+            compiledEdge.point[1] = curEdge->point(1);
+            compiledEdge.direction[0] = curEdge->direction(0).normalize(true);
+            compiledEdge.direction[1] = curEdge->direction(1).normalize(true);
+            compiledEdge.bisector[0] = (prevEdge->direction(1).normalize(true)+compiledEdge.direction[0]).normalize(true);
+            compiledEdge.bisector[1] = (compiledEdge.direction[1]+nextEdge->direction(0).normalize(true)).normalize(true);
+            {
+                const LinearSegment *segment = dynamic_cast<const LinearSegment *>(curEdge);
+                if (segment) {
+                    compiledEdge.type = LINEAR_EDGE;
+                    compiledEdge.index = compileLinearSegment(linearEdges, segment);
+                }
+            }
+            {
+                const QuadraticSegment *segment = dynamic_cast<const QuadraticSegment *>(curEdge);
+                if (segment) {
+                    compiledEdge.type = QUADRATIC_EDGE;
+                    compiledEdge.index = compileQuadraticSegment(quadraticEdges, segment);
+                }
+            }
+            {
+                const CubicSegment *segment = dynamic_cast<const CubicSegment *>(curEdge);
+                if (segment) {
+                    compiledEdge.type = CUBIC_EDGE;
+                    compiledEdge.index = compileCubicSegment(cubicEdges, cubicPieces, segment, cubicTolerance);
+                }
+            }
+            edges.push_back(compiledEdge);
+            prevEdge = curEdge;
+            curEdge = nextEdge;
+        }
+    }
+    contourOffsets.push_back((int) edges.size());
+}
+
+}
@@ -0,0 +1,105 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "SignedDistance.h"
+#include "EdgeColor.h"
+#include "Shape.h"
+
+// The maximum number of quadratic pieces a cubic segment is approximated with when a tolerance is specified
+#define MSDFGEN_CUBIC_MAX_PIECES 256
+
+namespace msdfgen {
+
+/// A read-only form of a Shape compiled for fast distance queries. The geometry of its edges is stored in contiguous arrays by segment type together with precomputed constants, so that distances can be computed without virtual calls.
+class CompiledShape {
+
+public:
+    enum EdgeType {
+        LINEAR_EDGE,
+        QUADRATIC_EDGE,
+        CUBIC_EDGE,
+        /// An edge of an unknown segment type, whose distance is computed by the source segment.
+        GENERIC_EDGE
+    };
+
+    /// The common properties of an edge. Edges are stored in the order in which ShapeDistanceFinder processes them.
+    struct Edge {
+        EdgeType type;
+        /// Index into the geometry arrays of the edge's type.
+        int index;
+        EdgeColor color;
+        /// The edge segment the edge was compiled from.
+        const EdgeSegment *segment;
+        /// The start and end point of the edge.
+        Point2 point[2];
+        /// The normalized (zero allowed) direction at the start and end point of the edge.
+        Vector2 direction[2];
+        /// The normalized (zero allowed) bisector of the corner at the start and end point of the edge.
+        Vector2 bisector[2];
+    };
+
+    /// Geometry of linear segments.
+    struct LinearEdges {
+        std::vector<Point2> p0, p1;
+        std::vector<Vector2> ab, orthonormal, unitDirection;
+        std::vector<double> abab;
+    };
+
+    /// Geometry of quadratic segments, including the coefficients of their distance equation independent of the origin.
+    struct QuadraticEdges {
+        std::vector<Point2> p0, p1, p2;
+        std::vector<Vector2> ab, br, p12, p02;
+        std::vector<double> a, b, c;
+        std::vector<Vector2> startDirection, endDirection, startUnitDirection, endUnitDirection;
+        std::vector<double> startDirectionSquared, endDirectionSquared;
+    };
+
+    /// Geometry of cubic segments.
+    struct CubicEdges {
+        std::vector<Point2> p0, p1, p2, p3;
+        std::vector<Vector2> ab, br, as, p12, p23;
+        std::vector<Vector2> startDirection, endDirection, startUnitDirection, endUnitDirection;
+        std::vector<double> startDirectionSquared, endDirectionSquared;
+        /// The range of the segment's quadratic pieces in CubicPieces. If the piece count is zero, the segment's distance is computed exactly by iterative search.
+        std::vector<int> firstPiece, pieceCount;
+    };
+
+    /// Quadratic pieces approximating cubic segments, with the coefficients of their distance equation and a circle bounding both the quadratic and the cubic piece.
+    struct CubicPieces {
+        std::vector<Point2> p0;
+        std::vector<Vector2> ab, br;
+        std::vector<double> a, b, c;
+        std::vector<Point2> center;
+        std::vector<double> radius;
+    };
+
+    /// The edges of all contours. The edges of contour i are in the range from contourOffsets[i] to contourOffsets[i+1].
+    std::vector<Edge> edges;
+    std::vector<int> contourOffsets;
+    /// The winding of each contour.
+    std::vector<int> windings;
+    LinearEdges linearEdges;
+    QuadraticEdges quadraticEdges;
+    CubicEdges cubicEdges;
+    CubicPieces cubicPieces;
+
+    // Passed shape object must persist and remain unmodified until the compiled shape is destroyed!
+    /// If cubicTolerance is positive, cubic segments are approximated by quadratic pieces deviating from them by at most this distance, which is faster than the exact iterative search.
+    explicit CompiledShape(const Shape &shape, double cubicTolerance = 0);
+    /// Returns the number of contours.
+    int contourCount() const;
+    /// Computes the signed distance between origin and an edge, identical to the one computed by the source EdgeSegment.
+    SignedDistance signedDistance(int edge, const Point2 &origin, double &param) const;
+    SignedDistance linearSignedDistance(int index, const Point2 &origin, double &param) const;
+    SignedDistance quadraticSignedDistance(int index, const Point2 &origin, double &param) const;
+    SignedDistance cubicSignedDistance(int index, const Point2 &origin, double &param) const;
+    /// Computes the signed distance to a cubic segment by finding the nearest points of the quadratic pieces approximating it. Its absolute value exceeds the exact distance by at most the tolerance.
+    SignedDistance approximateCubicSignedDistance(int index, const Point2 &origin, double &param) const;
+
+};
+
+}
+
+#include "CompiledShape.hpp"
@@ -0,0 +1,215 @@
+
+#include "CompiledShape.h"
+
+#include "arithmetics.hpp"
+#include "equation-solver.h"
+#include "edge-segments.h"
+
+namespace msdfgen {
+
+// The kernels replicate the computations of the respective EdgeSegment::signedDistance operation by operation, so that their results are identical
+
+inline int CompiledShape::contourCount() const {
+    return (int) contourOffsets.size()-1;
+}
+
+inline SignedDistance CompiledShape::signedDistance(int edge, const Point2 &origin, double &param) const {
+    switch (edges[edge].type) {
+        case LINEAR_EDGE:
+            return linearSignedDistance(edges[edge].index, origin, param);
+        case QUADRATIC_EDGE:
+            return quadraticSignedDistance(edges[edge].index, origin, param);
+        case CUBIC_EDGE:
+            return cubicSignedDistance(edges[edge].index, origin, param);
+        case GENERIC_EDGE:;
+    }
+    return edges[edge].segment->signedDistance(origin, param);
+}
+
+inline SignedDistance CompiledShape::linearSignedDistance(int index, const Point2 &origin, double &param) const {
+    const Vector2 &ab = linearEdges.ab[index];
+    Vector2 aq = origin-linearEdges.p0[index];
+    param = dotProduct(aq, ab)/linearEdges.abab[index];
+    Vector2 eq = (param > .5 ? linearEdges.p1[index] : linearEdges.p0[index])-origin;
+    double endpointDistance = eq.length();
+    if (param > 0 && param < 1) {
+        double orthoDistance = dotProduct(linearEdges.orthonormal[index], aq);
+        if (fabs(orthoDistance) < endpointDistance)
+            return SignedDistance(orthoDistance, 0);
+    }
+    return SignedDistance(nonZeroSign(crossProduct(aq, ab))*endpointDistance, fabs(dotProduct(linearEdges.unitDirection[index], eq.normalize())));
+}
+
+inline SignedDistance CompiledShape::quadraticSignedDistance(int index, const Point2 &origin, double &param) const {
+    const Vector2 &ab = quadraticEdges.ab[index];
+    const Vector2 &br = quadraticEdges.br[index];
+    Vector2 qa = quadraticEdges.p0[index]-origin;
+    double t[3];
+    int solutions = solveCubic(t, quadraticEdges.a[index], quadraticEdges.b[index], quadraticEdges.c[index]+dotProduct(qa, br), dotProduct(qa, ab));
+
+    Vector2 epDir = quadraticEdges.startDirection[index];
+    double minDistance = nonZeroSign(crossProduct(epDir, qa))*qa.length(); // distance from A
+    param = -dotProduct(qa, epDir)/quadraticEdges.startDirectionSquared[index];
+    Vector2 bq = quadraticEdges.p2[index]-origin;
+    {
+        epDir = quadraticEdges.endDirection[index];
+        double distance = bq.length(); // distance from B
+        if (distance < fabs(minDistance)) {
+            minDistance = nonZeroSign(crossProduct(epDir, bq))*distance;
+            param = dotProduct(origin-quadraticEdges.p1[index], epDir)/quadraticEdges.endDirectionSquared[index];
+        }
+    }
+    for (int i = 0; i < solutions; ++i) {
+        if (t[i] > 0 && t[i] < 1) {
+            Point2 qe = quadraticEdges.p0[index]+2*t[i]*ab+t[i]*t[i]*br-origin;
+            double distance = qe.length();
+            if (distance <= fabs(minDistance)) {
+                Vector2 tangent = mix(ab, quadraticEdges.p12[index], t[i]);
+                if (!tangent)
+                    tangent = quadraticEdges.p02[index];
+                minDistance = nonZeroSign(crossProduct(tangent, qe))*distance;
+                param = t[i];
+            }
+        }
+    }
+
+    if (param >= 0 && param <= 1)
+        return SignedDistance(minDistance, 0);
+    if (param < .5)
+        return SignedDistance(minDistance, fabs(dotProduct(quadraticEdges.startUnitDirection[index], qa.normalize())));
+    else
+        return SignedDistance(minDistance, fabs(dotProduct(quadraticEdges.endUnitDirection[index], bq.normalize())));
+}
+
+inline SignedDistance CompiledShape::cubicSignedDistance(int index, const Point2 &origin, double &param) const {
+    if (cubicEdges.pieceCount[index])
+        return approximateCubicSignedDistance(index, origin, param);
+    const Vector2 &ab = cubicEdges.ab[index];
+    const Vector2 &br = cubicEdges.br[index];
+    const Vector2 &as = cubicEdges.as[index];
+    Vector2 qa = cubicEdges.p0[index]-origin;
+
+    Vector2 epDir = cubicEdges.startDirection[index];
+    double minDistance = nonZeroSign(crossProduct(epDir, qa))*qa.length(); // distance from A
+    param = -dotProduct(qa, epDir)/cubicEdges.startDirectionSquared[index];
+    Vector2 bq = cubicEdges.p3[index]-origin;
+    {
+        epDir = cubicEdges.endDirection[index];
+        double distance = bq.length(); // distance from B
+        if (distance < fabs(minDistance)) {
+            minDistance = nonZeroSign(crossProduct(epDir, bq))*distance;
+            param = dotProduct(epDir-bq, epDir)/cubicEdges.endDirectionSquared[index];
+        }
+    }
+    // Iterative minimum distance search
+    for (int i = 0; i <= MSDFGEN_CUBIC_SEARCH_STARTS; ++i) {
+        double t = (double) i/MSDFGEN_CUBIC_SEARCH_STARTS;
+        Vector2 qe = qa+3*t*ab+3*t*t*br+t*t*t*as;
+        for (int step = 0; step < MSDFGEN_CUBIC_SEARCH_STEPS; ++step) {
+            // Improve t
+            Vector2 d1 = 3*as*t*t+6*br*t+3*ab;
+            Vector2 d2 = 6*as*t+6*br;
+            t -= dotProduct(qe, d1)/(dotProduct(d1, d1)+dotProduct(qe, d2));
+            if (t <= 0 || t >= 1)
+                break;
+            qe = qa+3*t*ab+3*t*t*br+t*t*t*as;
+            double distance = qe.length();
+            if (distance < fabs(minDistance)) {
+                // The tangent's fallbacks for zero length only apply at the endpoints, which are never reached here
+                Vector2 tangent = mix(mix(ab, cubicEdges.p12[index], t), mix(cubicEdges.p12[index], cubicEdges.p23[index], t), t);
+                minDistance = nonZeroSign(crossProduct(tangent, qe))*distance;
+                param = t;
+            }
+        }
+    }
+
+    if (param >= 0 && param <= 1)
+        return SignedDistance(minDistance, 0);
+    if (param < .5)
+        return SignedDistance(minDistance, fabs(dotProduct(cubicEdges.startUnitDirection[index], qa.normalize())));
+    else
+        return SignedDistance(minDistance, fabs(dotProduct(cubicEdges.endUnitDirection[index], bq.normalize())));
+}
+
+inline SignedDistance CompiledShape::approximateCubicSignedDistance(int index, const Point2 &origin, double &param) const {
+    Vector2 qa = cubicEdges.p0[index]-origin;
+
+    Vector2 epDir = cubicEdges.startDirection[index];
+    double minDistance = nonZeroSign(crossProduct(epDir, qa))*qa.length(); // distance from A
+    param = -dotProduct(qa, epDir)/cubicEdges.startDirectionSquared[index];
+    Vector2 bq = cubicEdges.p3[index]-origin;
+    {
+        epDir = cubicEdges.endDirection[index];
+        double distance = bq.length(); // distance from B
+        if (distance < fabs(minDistance)) {
+            minDistance = nonZeroSign(crossProduct(epDir, bq))*distance;
+            param = dotProduct(epDir-bq, epDir)/cubicEdges.endDirectionSquared[index];
+        }
+    }
+    // The cubic curve is evaluated at the parameter values of the nearest points of its quadratic pieces and of the junctions between them, each refined by a Newton step
+    const Vector2 &ab = cubicEdges.ab[index];
+    const Vector2 &br = cubicEdges.br[index];
+    const Vector2 &as = cubicEdges.as[index];
+    int firstPiece = cubicEdges.firstPiece[index], pieceCount = cubicEdges.pieceCount[index];
+    // The piece closest to the origin is examined first so that the others can be skipped by their bounding circles
+    int nearestPiece = 0;
+    if (pieceCount > 1) {
+        Vector2 qc = cubicPieces.center[firstPiece]-origin;
+        double nearestSquared = dotProduct(qc, qc);
+        for (int i = 1; i < pieceCount; ++i) {
+            qc = cubicPieces.center[firstPiece+i]-origin;
+            if (dotProduct(qc, qc) < nearestSquared)
+                nearestSquared = dotProduct(qc, qc), nearestPiece = i;
+        }
+    }
+    for (int k = 0; k < pieceCount; ++k) {
+        int i = k == 0 ? nearestPiece : k == nearestPiece ? 0 : k;
+        int piece = firstPiece+i;
+        Vector2 qc = cubicPieces.center[piece]-origin;
+        double bound = fabs(minDistance)+cubicPieces.radius[piece];
+        if (dotProduct(qc, qc) > bound*bound)
+            continue;
+        double t[4];
+        int solutions = 0;
+        {
+            Vector2 qp = cubicPieces.p0[piece]-origin;
+            int pieceSolutions = solveCubic(t+1, cubicPieces.a[piece], cubicPieces.b[piece], cubicPieces.c[piece]+dotProduct(qp, cubicPieces.br[piece]), dotProduct(qp, cubicPieces.ab[piece]));
+            if (i > 0)
+                t[solutions++] = (double) i/pieceCount;
+            for (int j = 1; j <= pieceSolutions; ++j) {
+                if (t[j] > 0 && t[j] < 1)
+                    t[solutions++] = (i+t[j])/pieceCount;
+            }
+        }
+        for (int j = 0; j < solutions; ++j) {
+            double ct = t[j];
+            Vector2 qe;
+            for (int step = 0; step < 2; ++step) {
+                if (step) {
+                    // Improve t
+                    Vector2 d1 = 3*as*ct*ct+6*br*ct+3*ab;
+                    Vector2 d2 = 6*as*ct+6*br;
+                    ct -= dotProduct(qe, d1)/(dotProduct(d1, d1)+dotProduct(qe, d2));
+                    if (ct <= 0 || ct >= 1)
+                        break;
+                }
+                qe = qa+3*ct*ab+3*ct*ct*br+ct*ct*ct*as;
+                double distance = qe.length();
+                if (distance < fabs(minDistance)) {
+                    Vector2 tangent = mix(mix(ab, cubicEdges.p12[index], ct), mix(cubicEdges.p12[index], cubicEdges.p23[index], ct), ct);
+                    minDistance = nonZeroSign(crossProduct(tangent, qe))*distance;
+                    param = ct;
+                }
+            }
+        }
+    }
+
+    if (param >= 0 && param <= 1)
+        return SignedDistance(minDistance, 0);
+    if (param < .5)
+        return SignedDistance(minDistance, fabs(dotProduct(cubicEdges.startUnitDirection[index], qa.normalize())));
+    else
+        return SignedDistance(minDistance, fabs(dotProduct(cubicEdges.endUnitDirection[index], bq.normalize())));
+}
+
+}
@@ -0,0 +1,281 @@
+
+#pragma once
+
+#include <cmath>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define MSDFGEN_BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MSDFGEN_BATCH_SSE2
+#endif
+
+#define MSDFGEN_BATCH_SIZE 4
+
+namespace msdfgen {
+
+/*
+ * DoubleBatch holds MSDFGEN_BATCH_SIZE double precision values and performs arithmetic on all of them at once,
+ * using AVX or SSE2 instructions where available. Every operation is rounded exactly like its scalar counterpart,
+ * so computations written in terms of DoubleBatch yield bit-identical results to the equivalent scalar code.
+ * Its layout depends on the instruction set, so it must not be passed between differently compiled code.
+ * The functions fabs and sqrt are only found by argument-dependent lookup, so that they never hide the scalar ones.
+ */
+
+/// The result of comparing two DoubleBatches, a boolean for each lane.
+struct BatchMask {
+#if defined(MSDFGEN_BATCH_AVX)
+    __m256d v;
+    inline explicit BatchMask(__m256d v) : v(v) { }
+#elif defined(MSDFGEN_BATCH_SSE2)
+    __m128d lo, hi;
+    inline BatchMask(__m128d lo, __m128d hi) : lo(lo), hi(hi) { }
+#else
+    bool v[MSDFGEN_BATCH_SIZE];
+#endif
+
+    /// Returns a bit field with a bit set for each true lane.
+    inline int bits() const {
+#if defined(MSDFGEN_BATCH_AVX)
+        return _mm256_movemask_pd(v);
+#elif defined(MSDFGEN_BATCH_SSE2)
+        return _mm_movemask_pd(lo)|_mm_movemask_pd(hi)<<2;
+#else
+        int result = 0;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result |= int(v[i])<<i;
+        return result;
+#endif
+    }
+
+    inline bool any() const {
+        return bits() != 0;
+    }
+
+};
+
+/// A batch of MSDFGEN_BATCH_SIZE double precision values.
+struct DoubleBatch {
+    typedef BatchMask Mask;
+    /// Specifies whether the results of batch computations match the scalar ones, which may then be used interchangeably.
+    static const bool scalarEquivalent = true;
+
+#if defined(MSDFGEN_BATCH_AVX)
+    __m256d v;
+    inline explicit DoubleBatch(__m256d v) : v(v) { }
+    inline DoubleBatch(double value = 0) : v(_mm256_set1_pd(value)) { }
+    inline static DoubleBatch load(const double *values) {
+        return DoubleBatch(_mm256_loadu_pd(values));
+    }
+    inline void store(double *values) const {
+        _mm256_storeu_pd(values, v);
+    }
+    friend inline DoubleBatch fabs(const DoubleBatch &a) {
+        return DoubleBatch(_mm256_andnot_pd(_mm256_set1_pd(-0.), a.v));
+    }
+    friend inline DoubleBatch sqrt(const DoubleBatch &a) {
+        return DoubleBatch(_mm256_sqrt_pd(a.v));
+    }
+#elif defined(MSDFGEN_BATCH_SSE2)
+    __m128d lo, hi;
+    inline DoubleBatch(__m128d lo, __m128d hi) : lo(lo), hi(hi) { }
+    inline DoubleBatch(double value = 0) : lo(_mm_set1_pd(value)), hi(lo) { }
+    inline static DoubleBatch load(const double *values) {
+        return DoubleBatch(_mm_loadu_pd(values), _mm_loadu_pd(values+2));
+    }
+    inline void store(double *values) const {
+        _mm_storeu_pd(values, lo);
+        _mm_storeu_pd(values+2, hi);
+    }
+    friend inline DoubleBatch fabs(const DoubleBatch &a) {
+        __m128d signBit = _mm_set1_pd(-0.);
+        return DoubleBatch(_mm_andnot_pd(signBit, a.lo), _mm_andnot_pd(signBit, a.hi));
+    }
+    friend inline DoubleBatch sqrt(const DoubleBatch &a) {
+        return DoubleBatch(_mm_sqrt_pd(a.lo), _mm_sqrt_pd(a.hi));
+    }
+#else
+    double v[MSDFGEN_BATCH_SIZE];
+    inline DoubleBatch(double value = 0) {
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            v[i] = value;
+    }
+    inline static DoubleBatch load(const double *values) {
+        DoubleBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = values[i];
+        return result;
+    }
+    inline void store(double *values) const {
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            values[i] = v[i];
+    }
+    friend inline DoubleBatch fabs(const DoubleBatch &a) {
+        DoubleBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = ::fabs(a.v[i]);
+        return result;
+    }
+    friend inline DoubleBatch sqrt(const DoubleBatch &a) {
+        DoubleBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = ::sqrt(a.v[i]);
+        return result;
+    }
+#endif
+};
+
+#if defined(MSDFGEN_BATCH_AVX)
+
+#define MSDFGEN_BATCH_ARITHMETIC_OPERATOR(op, instruction) \
+    inline DoubleBatch operator op(const DoubleBatch &a, const DoubleBatch &b) { return DoubleBatch(instruction(a.v, b.v)); }
+#define MSDFGEN_BATCH_COMPARISON_OPERATOR(op, predicate) \
+    inline BatchMask operator op(const DoubleBatch &a, const DoubleBatch &b) { return BatchMask(_mm256_cmp_pd(a.v, b.v, predicate)); }
+
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(+, _mm256_add_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(-, _mm256_sub_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(*, _mm256_mul_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(/, _mm256_div_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<, _CMP_LT_OQ)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<=, _CMP_LE_OQ)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>, _CMP_GT_OQ)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>=, _CMP_GE_OQ)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(==, _CMP_EQ_OQ)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(!=, _CMP_NEQ_UQ)
+
+inline DoubleBatch operator-(const DoubleBatch &a) {
+    return DoubleBatch(_mm256_xor_pd(a.v, _mm256_set1_pd(-0.)));
+}
+
+inline BatchMask operator&(const BatchMask &a, const BatchMask &b) {
+    return BatchMask(_mm256_and_pd(a.v, b.v));
+}
+
+inline BatchMask operator|(const BatchMask &a, const BatchMask &b) {
+    return BatchMask(_mm256_or_pd(a.v, b.v));
+}
+
+inline BatchMask operator!(const BatchMask &a) {
+    return BatchMask(_mm256_xor_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))));
+}
+
+/// Returns the lanes of a where mask is true and the lanes of b elsewhere.
+inline DoubleBatch select(const BatchMask &mask, const DoubleBatch &a, const DoubleBatch &b) {
+    return DoubleBatch(_mm256_blendv_pd(b.v, a.v, mask.v));
+}
+
+#elif defined(MSDFGEN_BATCH_SSE2)
+
+#define MSDFGEN_BATCH_ARITHMETIC_OPERATOR(op, instruction) \
+    inline DoubleBatch operator op(const DoubleBatch &a, const DoubleBatch &b) { return DoubleBatch(instruction(a.lo, b.lo), instruction(a.hi, b.hi)); }
+#define MSDFGEN_BATCH_COMPARISON_OPERATOR(op, instruction) \
+    inline BatchMask operator op(const DoubleBatch &a, const DoubleBatch &b) { return BatchMask(instruction(a.lo, b.lo), instruction(a.hi, b.hi)); }
+
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(+, _mm_add_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(-, _mm_sub_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(*, _mm_mul_pd)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(/, _mm_div_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<, _mm_cmplt_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<=, _mm_cmple_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>, _mm_cmpgt_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>=, _mm_cmpge_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(==, _mm_cmpeq_pd)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(!=, _mm_cmpneq_pd)
+
+inline DoubleBatch operator-(const DoubleBatch &a) {
+    __m128d signBit = _mm_set1_pd(-0.);
+    return DoubleBatch(_mm_xor_pd(a.lo, signBit), _mm_xor_pd(a.hi, signBit));
+}
+
+inline BatchMask operator&(const BatchMask &a, const BatchMask &b) {
+    return BatchMask(_mm_and_pd(a.lo, b.lo), _mm_and_pd(a.hi, b.hi));
+}
+
+inline BatchMask operator|(const BatchMask &a, const BatchMask &b) {
+    return BatchMask(_mm_or_pd(a.lo, b.lo), _mm_or_pd(a.hi, b.hi));
+}
+
+inline BatchMask operator!(const BatchMask &a) {
+    __m128d allBits = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    return BatchMask(_mm_xor_pd(a.lo, allBits), _mm_xor_pd(a.hi, allBits));
+}
+
+/// Returns the lanes of a where mask is true and the lanes of b elsewhere.
+inline DoubleBatch select(const BatchMask &mask, const DoubleBatch &a, const DoubleBatch &b) {
+    return DoubleBatch(
+        _mm_or_pd(_mm_and_pd(mask.lo, a.lo), _mm_andnot_pd(mask.lo, b.lo)),
+        _mm_or_pd(_mm_and_pd(mask.hi, a.hi), _mm_andnot_pd(mask.hi, b.hi))
+    );
+}
+
+#else
+
+#define MSDFGEN_BATCH_ARITHMETIC_OPERATOR(op) \
+    inline DoubleBatch operator op(const DoubleBatch &a, const DoubleBatch &b) { \
+        DoubleBatch result; \
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) \
+            result.v[i] = a.v[i] op b.v[i]; \
+        return result; \
+    }
+#define MSDFGEN_BATCH_COMPARISON_OPERATOR(op) \
+    inline BatchMask operator op(const DoubleBatch &a, const DoubleBatch &b) { \
+        BatchMask result; \
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) \
+            result.v[i] = a.v[i] op b.v[i]; \
+        return result; \
+    }
+
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(+)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(-)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(*)
+MSDFGEN_BATCH_ARITHMETIC_OPERATOR(/)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(<=)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(>=)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(==)
+MSDFGEN_BATCH_COMPARISON_OPERATOR(!=)
+
+inline DoubleBatch operator-(const DoubleBatch &a) {
+    DoubleBatch result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = -a.v[i];
+    return result;
+}
+
+inline BatchMask operator&(const BatchMask &a, const BatchMask &b) {
+    BatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = a.v[i] && b.v[i];
+    return result;
+}
+
+inline BatchMask operator|(const BatchMask &a, const BatchMask &b) {
+    BatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = a.v[i] || b.v[i];
+    return result;
+}
+
+inline BatchMask operator!(const BatchMask &a) {
+    BatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = !a.v[i];
+    return result;
+}
+
+/// Returns the lanes of a where mask is true and the lanes of b elsewhere.
+inline DoubleBatch select(const BatchMask &mask, const DoubleBatch &a, const DoubleBatch &b) {
+    DoubleBatch result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    return result;
+}
+
+#endif
+
+#undef MSDFGEN_BATCH_ARITHMETIC_OPERATOR
+#undef MSDFGEN_BATCH_COMPARISON_OPERATOR
+
+}
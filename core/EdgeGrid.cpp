@@ -0,0 +1,153 @@
+
+#include "EdgeGrid.h"
+
+#include <cmath>
+#include <algorithm>
+#include "arithmetics.hpp"
+
+// Edges whose pseudo-distance extensions may reach farther than this multiple of the search radius bypass the grid
+#define EDGE_GRID_REACH_FACTOR 2.
+// Absolute margin of the search area relative to the cell size, which covers the rounding errors of edge bounds
+#define EDGE_GRID_EPSILON .000001
+// Maximum number of cells along each axis
+#define EDGE_GRID_MAX_DIMENSION 256
+// Contours with fewer edges are always processed in full
+#define EDGE_GRID_MIN_CONTOUR_EDGES 16
+
+namespace msdfgen {
+
+/*
+ * An edge can affect a query whose result does not exceed radius either by its true distance, which is at least
+ * the distance to the edge's bounding box, or by a pseudo-distance to the extension of one of its endpoints.
+ * The latter is only accepted if it is below radius and the point lies on the far side of the bisector of the corner
+ * at that endpoint, which confines the point to within radius/cos(theta/2) of the endpoint, theta being the angle
+ * between the adjacent edges' directions. The endpoint is within the edge's bounding box, so it suffices to search
+ * EDGE_GRID_REACH_FACTOR*radius around the point, except for edges at sharper corners, which are always listed.
+ */
+static bool isSharpCorner(const Vector2 &inDir, const Vector2 &outDir) {
+    return !(EDGE_GRID_REACH_FACTOR*dotProduct(outDir, (inDir+outDir).normalize(true)) > 1.001);
+}
+
+static int cellCoordinate(double x, int size) {
+    if (!(x >= 0))
+        return 0;
+    if (x >= size)
+        return size-1;
+    return (int) x;
+}
+
+EdgeGrid::EdgeGrid(const Shape &shape) : left(0), bottom(0), cellSize(1), columns(1), rows(1) {
+    int edgeCount = shape.edgeCount();
+    Shape::Bounds bounds = shape.getBounds();
+    if (edgeCount > 0 && bounds.l <= bounds.r && bounds.b <= bounds.t) {
+        double width = bounds.r-bounds.l, height = bounds.t-bounds.b;
+        cellSize = sqrt(width*height/edgeCount);
+        if (!(cellSize > 0))
+            cellSize = max(width, height)/edgeCount;
+        if (!(cellSize > 0))
+            cellSize = 1;
+        columns = clamp((int) ceil(width/cellSize), 1, EDGE_GRID_MAX_DIMENSION);
+        rows = clamp((int) ceil(height/cellSize), 1, EDGE_GRID_MAX_DIMENSION);
+        cellSize = max(cellSize, max(width/columns, height/rows));
+        left = bounds.l, bottom = bounds.b;
+    }
+
+    // Determine each edge's cell range and sort out edges at sharp corners
+    std::vector<int> edgeCellRanges;
+    edgeCellRanges.reserve(4*edgeCount);
+    contourCells.resize(shape.contours.size());
+    int firstEdge = 0;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        ContourCell &contourCell = contourCells[contour-shape.contours.begin()];
+        contourCell.firstEdge = firstEdge;
+        contourCell.edgeCount = (int) contour->edges.size();
+        contourCell.firstSharpEdge = (int) sharpEdges.size();
+        contourCell.l = bounds.r, contourCell.b = bounds.t, contourCell.r = bounds.l, contourCell.t = bounds.b;
+        if (!contour->edges.empty()) {
+            const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+            const EdgeSegment *curEdge = contour->edges.back();
+            for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+                const EdgeSegment *nextEdge = *edge;
+                double l = bounds.r, b = bounds.t, r = bounds.l, t = bounds.b;
+                curEdge->bound(l, b, r, t);
+                contourCell.l = min(contourCell.l, l), contourCell.b = min(contourCell.b, b);
+                contourCell.r = max(contourCell.r, r), contourCell.t = max(contourCell.t, t);
+                edgeCellRanges.push_back(cellCoordinate((l-left)/cellSize, columns));
+                edgeCellRanges.push_back(cellCoordinate((b-bottom)/cellSize, rows));
+                edgeCellRanges.push_back(cellCoordinate((r-left)/cellSize, columns));
+                edgeCellRanges.push_back(cellCoordinate((t-bottom)/cellSize, rows));
+                if (
+                    isSharpCorner(prevEdge->direction(1).normalize(true), curEdge->direction(0).normalize(true)) ||
+                    isSharpCorner(curEdge->direction(1).normalize(true), nextEdge->direction(0).normalize(true))
+                )
+                    sharpEdges.push_back(int(edge-contour->edges.begin()));
+                prevEdge = curEdge;
+                curEdge = nextEdge;
+            }
+        }
+        contourCell.sharpEdgeCount = (int) sharpEdges.size()-contourCell.firstSharpEdge;
+        firstEdge += contourCell.edgeCount;
+    }
+
+    // Fill the cells, each listing its edges in ascending order
+    cellOffsets.resize(columns*rows+1, 0);
+    for (int i = 0; i < edgeCount; ++i) {
+        const int *range = &edgeCellRanges[4*i];
+        for (int y = range[1]; y <= range[3]; ++y)
+            for (int x = range[0]; x <= range[2]; ++x)
+                ++cellOffsets[y*columns+x+1];
+    }
+    for (int i = 0; i < columns*rows; ++i)
+        cellOffsets[i+1] += cellOffsets[i];
+    cellEdges.resize(cellOffsets.back());
+    std::vector<int> cellFill(cellOffsets.begin(), cellOffsets.end()-1);
+    for (int i = 0; i < edgeCount; ++i) {
+        const int *range = &edgeCellRanges[4*i];
+        for (int y = range[1]; y <= range[3]; ++y)
+            for (int x = range[0]; x <= range[2]; ++x)
+                cellEdges[cellFill[y*columns+x]++] = i;
+    }
+}
+
+bool EdgeGrid::findEdges(std::vector<int> &edges, int contourIndex, const Point2 &origin, double radius) const {
+    return findEdges(edges, contourIndex, &origin, &radius, 1);
+}
+
+bool EdgeGrid::findEdges(std::vector<int> &edges, int contourIndex, const Point2 *origins, const double *radii, int count) const {
+    const ContourCell &contourCell = contourCells[contourIndex];
+    if (contourCell.edgeCount < EDGE_GRID_MIN_CONTOUR_EDGES)
+        return false;
+    // The search area is the bounding box of the individual queries' search areas
+    double l = origins[0].x, b = origins[0].y, r = origins[0].x, t = origins[0].y;
+    for (int i = 0; i < count; ++i) {
+        double reach = EDGE_GRID_REACH_FACTOR*radii[i]+EDGE_GRID_EPSILON*cellSize;
+        l = min(l, origins[i].x-reach), b = min(b, origins[i].y-reach);
+        r = max(r, origins[i].x+reach), t = max(t, origins[i].y+reach);
+    }
+    // If the search area covers the whole contour, which is common for distant contours in overlap support mode, all of its edges are processed
+    if (l <= contourCell.l && b <= contourCell.b && r >= contourCell.r && t >= contourCell.t)
+        return false;
+    l = max(l, contourCell.l), b = max(b, contourCell.b);
+    r = min(r, contourCell.r), t = min(t, contourCell.t);
+    edges.assign(sharpEdges.begin()+contourCell.firstSharpEdge, sharpEdges.begin()+contourCell.firstSharpEdge+contourCell.sharpEdgeCount);
+    if (l <= r && b <= t) {
+        int x0 = cellCoordinate((l-left)/cellSize, columns), y0 = cellCoordinate((b-bottom)/cellSize, rows);
+        int x1 = cellCoordinate((r-left)/cellSize, columns), y1 = cellCoordinate((t-bottom)/cellSize, rows);
+        if ((x1-x0+1)*(y1-y0+1) > contourCell.edgeCount)
+            return false;
+        bool multiple = !edges.empty() || x1 > x0 || y1 > y0;
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x) {
+                std::vector<int>::const_iterator end = cellEdges.begin()+cellOffsets[y*columns+x+1];
+                for (std::vector<int>::const_iterator edge = std::lower_bound(cellEdges.begin()+cellOffsets[y*columns+x], end, contourCell.firstEdge); edge != end && *edge < contourCell.firstEdge+contourCell.edgeCount; ++edge)
+                    edges.push_back(*edge-contourCell.firstEdge);
+            }
+        if (multiple) {
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        }
+    }
+    return true;
+}
+
+}
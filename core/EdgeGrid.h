@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "Shape.h"
+
+namespace msdfgen {
+
+/// A uniform grid that indexes a shape's edges by their location, which allows distance queries to skip edges that provably cannot affect the result.
+class EdgeGrid {
+
+public:
+    // Passed shape object must persist and remain unmodified until the grid is destroyed!
+    explicit EdgeGrid(const Shape &shape);
+    /// Lists the edges of a contour that may affect a distance query at origin whose result is known not to exceed radius. The edges are identified by their position in the order in which ShapeDistanceFinder processes them and listed in that order. Returns false if processing all of the contour's edges is expected to be faster.
+    bool findEdges(std::vector<int> &edges, int contourIndex, const Point2 &origin, double radius) const;
+    /// Lists the edges of a contour that may affect any of count distance queries at origins[i] whose results are known not to exceed radii[i].
+    bool findEdges(std::vector<int> &edges, int contourIndex, const Point2 *origins, const double *radii, int count) const;
+
+private:
+    struct ContourCell {
+        int firstEdge, edgeCount;
+        int firstSharpEdge, sharpEdgeCount;
+        double l, b, r, t;
+    };
+
+    double left, bottom, cellSize;
+    int columns, rows;
+    std::vector<ContourCell> contourCells;
+    std::vector<int> cellOffsets;
+    std::vector<int> cellEdges;
+    std::vector<int> sharpEdges;
+
+};
+
+}
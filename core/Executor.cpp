@@ -0,0 +1,51 @@
+
+#include "Executor.h"
+
+#ifdef MSDFGEN_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace msdfgen {
+
+DefaultExecutor &DefaultExecutor::instance() {
+    static DefaultExecutor executor;
+    return executor;
+}
+
+int DefaultExecutor::threadCount() const {
+#ifdef MSDFGEN_USE_OPENMP
+    return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+void DefaultExecutor::parallelFor(int count, Task task, void *context) {
+#ifdef MSDFGEN_USE_OPENMP
+    // Within another parallel region, the tasks are run on the calling thread only
+    if (!omp_in_parallel()) {
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < count; ++i)
+            task(context, i, omp_get_thread_num());
+        return;
+    }
+#endif
+    for (int i = 0; i < count; ++i)
+        task(context, i, 0);
+}
+
+SerialExecutor &SerialExecutor::instance() {
+    static SerialExecutor executor;
+    return executor;
+}
+
+int SerialExecutor::threadCount() const {
+    return 1;
+}
+
+void SerialExecutor::parallelFor(int count, Task task, void *context) {
+    for (int i = 0; i < count; ++i)
+        task(context, i, 0);
+}
+
+}
@@ -0,0 +1,61 @@
+
+#pragma once
+
+namespace msdfgen {
+
+/// Runs the parallel loops of the multithreaded stages. May be implemented to execute them on an application's own threads.
+class Executor {
+
+public:
+    /// A task processing the item index on the thread numbered thread.
+    typedef void (*Task)(void *context, int index, int thread);
+
+    virtual ~Executor() { }
+    /// Returns the number of threads that may run tasks, which are numbered from 0.
+    virtual int threadCount() const = 0;
+    /// Calls task(context, index, thread) for each index from 0 to count-1 and returns when all calls have finished. Calls running at the same time are given different thread numbers.
+    virtual void parallelFor(int count, Task task, void *context) = 0;
+
+};
+
+/// The executor used when none is specified, which runs the tasks with OpenMP if enabled or on the calling thread otherwise.
+class DefaultExecutor : public Executor {
+
+public:
+    /// Returns the shared instance.
+    static DefaultExecutor &instance();
+
+    int threadCount() const;
+    void parallelFor(int count, Task task, void *context);
+
+};
+
+/// An executor which runs all tasks on the calling thread.
+class SerialExecutor : public Executor {
+
+public:
+    /// Returns the shared instance.
+    static SerialExecutor &instance();
+
+    int threadCount() const;
+    void parallelFor(int count, Task task, void *context);
+
+};
+
+/// Returns executor, or the default executor if it is NULL.
+inline Executor &resolveExecutor(Executor *executor) {
+    return executor ? *executor : DefaultExecutor::instance();
+}
+
+template <class Functor>
+void runParallelTask(void *context, int index, int thread) {
+    (*reinterpret_cast<Functor *>(context))(index, thread);
+}
+
+/// Calls functor(index, thread) for each index from 0 to count-1 with the executor, or the default executor if it is NULL.
+template <class Functor>
+inline void parallelFor(Executor *executor, int count, Functor &functor) {
+    resolveExecutor(executor).parallelFor(count, &runParallelTask<Functor>, &functor);
+}
+
+}
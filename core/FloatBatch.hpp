@@ -0,0 +1,206 @@
+
+#pragma once
+
+#include "DoubleBatch.hpp"
+
+#if defined(MSDFGEN_BATCH_AVX) || defined(MSDFGEN_BATCH_SSE2)
+    #define MSDFGEN_FLOAT_BATCH_SSE
+#endif
+
+namespace msdfgen {
+
+/*
+ * FloatBatch is the single precision counterpart of DoubleBatch with the same interface, so that the batch computations can be instantiated for either.
+ * Its MSDFGEN_BATCH_SIZE values fit into a single SSE register, which halves the number of instructions compared to DoubleBatch without AVX
+ * and makes division and square root considerably faster. Values are converted from and to double precision when loaded and stored.
+ */
+
+/// The result of comparing two FloatBatches, a boolean for each lane.
+struct FloatBatchMask {
+#ifdef MSDFGEN_FLOAT_BATCH_SSE
+    __m128 v;
+    inline explicit FloatBatchMask(__m128 v) : v(v) { }
+#else
+    bool v[MSDFGEN_BATCH_SIZE];
+#endif
+
+    /// Returns a bit field with a bit set for each true lane.
+    inline int bits() const {
+#ifdef MSDFGEN_FLOAT_BATCH_SSE
+        return _mm_movemask_ps(v);
+#else
+        int result = 0;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result |= int(v[i])<<i;
+        return result;
+#endif
+    }
+
+    inline bool any() const {
+        return bits() != 0;
+    }
+
+};
+
+/// A batch of MSDFGEN_BATCH_SIZE single precision values.
+struct FloatBatch {
+    typedef FloatBatchMask Mask;
+    static const bool scalarEquivalent = false;
+
+#ifdef MSDFGEN_FLOAT_BATCH_SSE
+    __m128 v;
+    inline explicit FloatBatch(__m128 v) : v(v) { }
+    inline FloatBatch(double value = 0) : v(_mm_set1_ps(float(value))) { }
+    inline static FloatBatch load(const double *values) {
+        return FloatBatch(_mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(values)), _mm_cvtpd_ps(_mm_loadu_pd(values+2))));
+    }
+    inline void store(double *values) const {
+        _mm_storeu_pd(values, _mm_cvtps_pd(v));
+        _mm_storeu_pd(values+2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    friend inline FloatBatch fabs(const FloatBatch &a) {
+        return FloatBatch(_mm_andnot_ps(_mm_set1_ps(-0.f), a.v));
+    }
+    friend inline FloatBatch sqrt(const FloatBatch &a) {
+        return FloatBatch(_mm_sqrt_ps(a.v));
+    }
+#else
+    float v[MSDFGEN_BATCH_SIZE];
+    inline FloatBatch(double value = 0) {
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            v[i] = float(value);
+    }
+    inline static FloatBatch load(const double *values) {
+        FloatBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = float(values[i]);
+        return result;
+    }
+    inline void store(double *values) const {
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            values[i] = v[i];
+    }
+    friend inline FloatBatch fabs(const FloatBatch &a) {
+        FloatBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = ::fabsf(a.v[i]);
+        return result;
+    }
+    friend inline FloatBatch sqrt(const FloatBatch &a) {
+        FloatBatch result;
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            result.v[i] = ::sqrtf(a.v[i]);
+        return result;
+    }
+#endif
+};
+
+#ifdef MSDFGEN_FLOAT_BATCH_SSE
+
+#define MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(op, instruction) \
+    inline FloatBatch operator op(const FloatBatch &a, const FloatBatch &b) { return FloatBatch(instruction(a.v, b.v)); }
+#define MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(op, instruction) \
+    inline FloatBatchMask operator op(const FloatBatch &a, const FloatBatch &b) { return FloatBatchMask(instruction(a.v, b.v)); }
+
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(+, _mm_add_ps)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(-, _mm_sub_ps)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(*, _mm_mul_ps)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(/, _mm_div_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(<, _mm_cmplt_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(<=, _mm_cmple_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(>, _mm_cmpgt_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(>=, _mm_cmpge_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(==, _mm_cmpeq_ps)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(!=, _mm_cmpneq_ps)
+
+inline FloatBatch operator-(const FloatBatch &a) {
+    return FloatBatch(_mm_xor_ps(a.v, _mm_set1_ps(-0.f)));
+}
+
+inline FloatBatchMask operator&(const FloatBatchMask &a, const FloatBatchMask &b) {
+    return FloatBatchMask(_mm_and_ps(a.v, b.v));
+}
+
+inline FloatBatchMask operator|(const FloatBatchMask &a, const FloatBatchMask &b) {
+    return FloatBatchMask(_mm_or_ps(a.v, b.v));
+}
+
+inline FloatBatchMask operator!(const FloatBatchMask &a) {
+    return FloatBatchMask(_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+}
+
+/// Returns the lanes of a where mask is true and the lanes of b elsewhere.
+inline FloatBatch select(const FloatBatchMask &mask, const FloatBatch &a, const FloatBatch &b) {
+    return FloatBatch(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+}
+
+#else
+
+#define MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(op) \
+    inline FloatBatch operator op(const FloatBatch &a, const FloatBatch &b) { \
+        FloatBatch result; \
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) \
+            result.v[i] = a.v[i] op b.v[i]; \
+        return result; \
+    }
+#define MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(op) \
+    inline FloatBatchMask operator op(const FloatBatch &a, const FloatBatch &b) { \
+        FloatBatchMask result; \
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) \
+            result.v[i] = a.v[i] op b.v[i]; \
+        return result; \
+    }
+
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(+)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(-)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(*)
+MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR(/)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(<)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(<=)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(>)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(>=)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(==)
+MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR(!=)
+
+inline FloatBatch operator-(const FloatBatch &a) {
+    FloatBatch result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = -a.v[i];
+    return result;
+}
+
+inline FloatBatchMask operator&(const FloatBatchMask &a, const FloatBatchMask &b) {
+    FloatBatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = a.v[i] && b.v[i];
+    return result;
+}
+
+inline FloatBatchMask operator|(const FloatBatchMask &a, const FloatBatchMask &b) {
+    FloatBatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = a.v[i] || b.v[i];
+    return result;
+}
+
+inline FloatBatchMask operator!(const FloatBatchMask &a) {
+    FloatBatchMask result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = !a.v[i];
+    return result;
+}
+
+/// Returns the lanes of a where mask is true and the lanes of b elsewhere.
+inline FloatBatch select(const FloatBatchMask &mask, const FloatBatch &a, const FloatBatch &b) {
+    FloatBatch result;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+        result.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    return result;
+}
+
+#endif
+
+#undef MSDFGEN_FLOAT_BATCH_ARITHMETIC_OPERATOR
+#undef MSDFGEN_FLOAT_BATCH_COMPARISON_OPERATOR
+
+}
@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include <cstdlib>
+#include "Vector2.h"
+#include "Shape.h"
+#include "BitmapRef.hpp"
+
+namespace msdfgen {
+
+/// A distance field to be generated as part of a batch: the shape, the bitmap to generate it into, and the range and transformation as in the single-shape generator functions.
+template <typename T, int N>
+struct GeneratorJob {
+
+    /// The shape, which must persist until the batch is finished. Edge colors must be assigned first for multi-channel distance fields.
+    const Shape *shape;
+    BitmapRef<T, N> output;
+    double range;
+    Vector2 scale, translate;
+
+    inline GeneratorJob() : shape(NULL), range(1), scale(1) { }
+    inline GeneratorJob(const Shape &shape, const BitmapRef<T, N> &output, double range, const Vector2 &scale, const Vector2 &translate) : shape(&shape), output(output), range(range), scale(scale), translate(translate) { }
+
+};
+
+}
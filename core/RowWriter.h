@@ -0,0 +1,19 @@
+
+#pragma once
+
+namespace msdfgen {
+
+/// Receives the rows of an N-channel floating-point bitmap one at a time, so that they may be written out without holding the whole bitmap in memory.
+template <int N>
+class RowWriter {
+
+public:
+    virtual ~RowWriter() { }
+    /// Returns true if the rows are to be passed from the top one (y = height-1) down, which is the order of most image files, or false if from the bottom one up.
+    virtual bool topDown() const = 0;
+    /// Writes the next row of pixels, whose width has been specified when the writer was opened. Returns false on failure, after which no more rows are passed.
+    virtual bool writeRow(const float *pixels) = 0;
+
+};
+
+}
@@ -0,0 +1,69 @@
+
+#include "ScanlineGenerator.h"
+
+#include <algorithm>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+template <int N>
+static void controlPointRange(double &yMin, double &yMax, const Point2 (&p)[N]) {
+    yMin = p[0].y, yMax = p[0].y;
+    for (int i = 1; i < N; ++i) {
+        yMin = min(yMin, p[i].y);
+        yMax = max(yMax, p[i].y);
+    }
+}
+
+ScanlineGenerator::ScanlineGenerator(const Shape &shape) : nextEdge(0), lastY(0) {
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            EdgeRange range;
+            range.edge = *edge;
+            if (const LinearSegment *segment = dynamic_cast<const LinearSegment *>(range.edge))
+                controlPointRange(range.yMin, range.yMax, segment->p);
+            else if (const QuadraticSegment *segment = dynamic_cast<const QuadraticSegment *>(range.edge))
+                controlPointRange(range.yMin, range.yMax, segment->p);
+            else if (const CubicSegment *segment = dynamic_cast<const CubicSegment *>(range.edge))
+                controlPointRange(range.yMin, range.yMax, segment->p);
+            else {
+                // The intersections of an unknown segment type can only be bounded conservatively
+                range.yMin = -1e240, range.yMax = 1e240;
+            }
+            edges.push_back(range);
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end());
+}
+
+void ScanlineGenerator::scanline(Scanline &line, double y) {
+    // Restart the sweep if moving downwards
+    if (y < lastY) {
+        nextEdge = 0;
+        activeEdges.clear();
+    }
+    lastY = y;
+    while (nextEdge < (int) edges.size() && edges[nextEdge].yMin <= y)
+        activeEdges.push_back(&edges[nextEdge++]);
+    intersections.clear();
+    double x[3];
+    int dy[3];
+    for (int i = 0; i < (int) activeEdges.size();) {
+        const EdgeRange *edge = activeEdges[i];
+        if (edge->yMax < y) {
+            // Remove edge below scanline, which will not cross any of the following ones
+            activeEdges[i] = activeEdges.back();
+            activeEdges.pop_back();
+            continue;
+        }
+        int n = edge->edge->scanlineIntersections(x, dy, y);
+        for (int j = 0; j < n; ++j) {
+            Scanline::Intersection intersection = { x[j], dy[j] };
+            intersections.push_back(intersection);
+        }
+        ++i;
+    }
+    line.setIntersections(intersections);
+}
+
+}
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include <vector>
+#include "Shape.h"
+#include "Scanline.h"
+
+namespace msdfgen {
+
+/// Produces the scanlines of a shape by sweeping over its edges sorted by vertical extent, so that only the edges crossing a scanline are intersected with it. Successive scanlines are fastest to produce in order of increasing y.
+class ScanlineGenerator {
+
+public:
+    // Passed shape object must persist and remain unmodified until the generator is destroyed!
+    explicit ScanlineGenerator(const Shape &shape);
+    /// Outputs the scanline that intersects the shape at y, equal to the one output by Shape::scanline.
+    void scanline(Scanline &line, double y);
+
+private:
+    /// An edge along with the vertical extent of its control points, which contains all of its intersections.
+    struct EdgeRange {
+        double yMin, yMax;
+        const EdgeSegment *edge;
+
+        bool operator<(const EdgeRange &other) const {
+            return yMin < other.yMin;
+        }
+    };
+
+    /// Edges sorted by yMin.
+    std::vector<EdgeRange> edges;
+    /// Edges that start at or below the last y and may still cross scanlines at or above it.
+    std::vector<const EdgeRange *> activeEdges;
+    int nextEdge;
+    double lastY;
+    std::vector<Scanline::Intersection> intersections;
+
+};
+
+}
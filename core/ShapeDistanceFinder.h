@@ -3,13 +3,15 @@
 
 #include <vector>
 #include "Vector2.h"
+#include "EdgeGrid.h"
+#include "CompiledShape.h"
 #include "edge-selectors.h"
 #include "contour-combiners.h"
 
 namespace msdfgen {
 
-/// Finds the distance between a point and a Shape. ContourCombiner dictates the distance metric and its data type.
-template <class ContourCombiner>
+/// Finds the distance between a point and a Shape. ContourCombiner dictates the distance metric and its data type. ShapeType may also be CompiledShape for faster queries.
+template <class ContourCombiner, class ShapeType = Shape>
 class ShapeDistanceFinder {
 
 public:
@@ -17,6 +19,8 @@ public:
 
     // Passed shape object must persist until the distance finder is destroyed!
     explicit ShapeDistanceFinder(const Shape &shape);
+    /// Uses edgeGrid (if not null), which must be built from the same shape, to skip edges far from the queried points.
+    ShapeDistanceFinder(const Shape &shape, const EdgeGrid *edgeGrid);
     /// Finds the distance from origin. Not thread-safe! Is fastest when subsequent queries are close together.
     DistanceType distance(const Point2 &origin);
 
@@ -25,8 +29,36 @@ public:
 
 private:
     const Shape &shape;
+    const EdgeGrid *edgeGrid;
+    ContourCombiner contourCombiner;
+    std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    std::vector<int> nearbyEdges;
+
+};
+
+/// Finds the distance between a point and a CompiledShape. Yields the same results as the distance finder of the source Shape.
+template <class ContourCombiner>
+class ShapeDistanceFinder<ContourCombiner, CompiledShape> {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    // Passed shape object must persist until the distance finder is destroyed!
+    explicit ShapeDistanceFinder(const CompiledShape &shape);
+    /// Uses edgeGrid (if not null), which must be built from the source shape, to skip edges far from the queried points.
+    ShapeDistanceFinder(const CompiledShape &shape, const EdgeGrid *edgeGrid);
+    /// Finds the distance from origin. Not thread-safe! Is fastest when subsequent queries are close together.
+    DistanceType distance(const Point2 &origin);
+
+    /// Finds the distance between shape and origin. Does not allocate result cache used to optimize performance of multiple queries.
+    static DistanceType oneShotDistance(const CompiledShape &shape, const Point2 &origin);
+
+private:
+    const CompiledShape &shape;
+    const EdgeGrid *edgeGrid;
     ContourCombiner contourCombiner;
     std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    std::vector<int> nearbyEdges;
 
 };
 
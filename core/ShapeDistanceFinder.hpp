@@ -3,25 +3,41 @@
 
 namespace msdfgen {
 
-template <class ContourCombiner>
-ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape) : shape(shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
+template <class ContourCombiner, class ShapeType>
+ShapeDistanceFinder<ContourCombiner, ShapeType>::ShapeDistanceFinder(const Shape &shape) : shape(shape), edgeGrid(NULL), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
 
-template <class ContourCombiner>
-typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<ContourCombiner>::distance(const Point2 &origin) {
+template <class ContourCombiner, class ShapeType>
+ShapeDistanceFinder<ContourCombiner, ShapeType>::ShapeDistanceFinder(const Shape &shape, const EdgeGrid *edgeGrid) : shape(shape), edgeGrid(edgeGrid), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
+
+template <class ContourCombiner, class ShapeType>
+typename ShapeDistanceFinder<ContourCombiner, ShapeType>::DistanceType ShapeDistanceFinder<ContourCombiner, ShapeType>::distance(const Point2 &origin) {
     contourCombiner.reset(origin);
     typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = &shapeEdgeCache[0];
 
     for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
         if (!contour->edges.empty()) {
-            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(int(contour-shape.contours.begin()));
+            int contourIndex = int(contour-shape.contours.begin());
+            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(contourIndex);
 
-            const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
-            const EdgeSegment *curEdge = contour->edges.back();
-            for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                const EdgeSegment *nextEdge = *edge;
-                edgeSelector.addEdge(*edgeCache++, prevEdge, curEdge, nextEdge);
-                prevEdge = curEdge;
-                curEdge = nextEdge;
+            if (edgeGrid && edgeGrid->findEdges(nearbyEdges, contourIndex, origin, edgeSelector.searchRadius())) {
+                // Only the listed edges are processed, in their usual order. The caches of the others remain valid.
+                int edgeCount = (int) contour->edges.size();
+                for (std::vector<int>::const_iterator edge = nearbyEdges.begin(); edge != nearbyEdges.end(); ++edge) {
+                    const EdgeSegment *prevEdge = contour->edges[(*edge+2*edgeCount-2)%edgeCount];
+                    const EdgeSegment *curEdge = contour->edges[(*edge+edgeCount-1)%edgeCount];
+                    const EdgeSegment *nextEdge = contour->edges[*edge];
+                    edgeSelector.addEdge(edgeCache[*edge], prevEdge, curEdge, nextEdge);
+                }
+                edgeCache += edgeCount;
+            } else {
+                const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+                const EdgeSegment *curEdge = contour->edges.back();
+                for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+                    const EdgeSegment *nextEdge = *edge;
+                    edgeSelector.addEdge(*edgeCache++, prevEdge, curEdge, nextEdge);
+                    prevEdge = curEdge;
+                    curEdge = nextEdge;
+                }
             }
         }
     }
@@ -29,8 +45,8 @@ typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<
     return contourCombiner.distance();
 }
 
-template <class ContourCombiner>
-typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<ContourCombiner>::oneShotDistance(const Shape &shape, const Point2 &origin) {
+template <class ContourCombiner, class ShapeType>
+typename ShapeDistanceFinder<ContourCombiner, ShapeType>::DistanceType ShapeDistanceFinder<ContourCombiner, ShapeType>::oneShotDistance(const Shape &shape, const Point2 &origin) {
     ContourCombiner contourCombiner(shape);
     contourCombiner.reset(origin);
 
@@ -53,4 +69,52 @@ typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<
     return contourCombiner.distance();
 }
 
+template <class ContourCombiner>
+ShapeDistanceFinder<ContourCombiner, CompiledShape>::ShapeDistanceFinder(const CompiledShape &shape) : shape(shape), edgeGrid(NULL), contourCombiner(shape), shapeEdgeCache(shape.edges.size()) { }
+
+template <class ContourCombiner>
+ShapeDistanceFinder<ContourCombiner, CompiledShape>::ShapeDistanceFinder(const CompiledShape &shape, const EdgeGrid *edgeGrid) : shape(shape), edgeGrid(edgeGrid), contourCombiner(shape), shapeEdgeCache(shape.edges.size()) { }
+
+template <class ContourCombiner>
+typename ShapeDistanceFinder<ContourCombiner, CompiledShape>::DistanceType ShapeDistanceFinder<ContourCombiner, CompiledShape>::distance(const Point2 &origin) {
+    contourCombiner.reset(origin);
+    int contourCount = shape.contourCount();
+
+    for (int i = 0; i < contourCount; ++i) {
+        int firstEdge = shape.contourOffsets[i], endEdge = shape.contourOffsets[i+1];
+        if (firstEdge < endEdge) {
+            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(i);
+            if (edgeGrid && edgeGrid->findEdges(nearbyEdges, i, origin, edgeSelector.searchRadius())) {
+                for (std::vector<int>::const_iterator edge = nearbyEdges.begin(); edge != nearbyEdges.end(); ++edge)
+                    edgeSelector.addEdge(shapeEdgeCache[firstEdge+*edge], shape, firstEdge+*edge);
+            } else {
+                for (int edge = firstEdge; edge < endEdge; ++edge)
+                    edgeSelector.addEdge(shapeEdgeCache[edge], shape, edge);
+            }
+        }
+    }
+
+    return contourCombiner.distance();
+}
+
+template <class ContourCombiner>
+typename ShapeDistanceFinder<ContourCombiner, CompiledShape>::DistanceType ShapeDistanceFinder<ContourCombiner, CompiledShape>::oneShotDistance(const CompiledShape &shape, const Point2 &origin) {
+    ContourCombiner contourCombiner(shape);
+    contourCombiner.reset(origin);
+    int contourCount = shape.contourCount();
+
+    for (int i = 0; i < contourCount; ++i) {
+        int firstEdge = shape.contourOffsets[i], endEdge = shape.contourOffsets[i+1];
+        if (firstEdge < endEdge) {
+            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(i);
+            for (int edge = firstEdge; edge < endEdge; ++edge) {
+                typename ContourCombiner::EdgeSelectorType::EdgeCache dummy;
+                edgeSelector.addEdge(dummy, shape, edge);
+            }
+        }
+    }
+
+    return contourCombiner.distance();
+}
+
 }
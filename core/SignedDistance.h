@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cmath>
+
 namespace msdfgen {
 
 /// Represents a signed distance and alignment, which together can be compared to uniquely determine the closest edge segment.
@@ -22,4 +24,24 @@ public:
 
 };
 
+inline SignedDistance::SignedDistance() : distance(-1e240), dot(1) { }
+
+inline SignedDistance::SignedDistance(double dist, double d) : distance(dist), dot(d) { }
+
+inline bool operator<(SignedDistance a, SignedDistance b) {
+    return fabs(a.distance) < fabs(b.distance) || (fabs(a.distance) == fabs(b.distance) && a.dot < b.dot);
+}
+
+inline bool operator>(SignedDistance a, SignedDistance b) {
+    return fabs(a.distance) > fabs(b.distance) || (fabs(a.distance) == fabs(b.distance) && a.dot > b.dot);
+}
+
+inline bool operator<=(SignedDistance a, SignedDistance b) {
+    return fabs(a.distance) < fabs(b.distance) || (fabs(a.distance) == fabs(b.distance) && a.dot <= b.dot);
+}
+
+inline bool operator>=(SignedDistance a, SignedDistance b) {
+    return fabs(a.distance) > fabs(b.distance) || (fabs(a.distance) == fabs(b.distance) && a.dot >= b.dot);
+}
+
 }
@@ -0,0 +1,129 @@
+
+#include "ThreadPool.h"
+
+#ifdef MSDFGEN_USE_CPP11
+
+namespace msdfgen {
+
+/// The pool whose tasks are being run by the current thread, if any.
+static thread_local const ThreadPool *activePool = NULL;
+
+ThreadPool::ThreadPool(int threadCount) : ranges(threadCount > 0 ? threadCount : std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1), task(NULL), context(NULL), job(0), busyWorkers(0), stopping(false) {
+    for (int i = 0; i < (int) ranges.size(); ++i)
+        ranges[i].begin = 0, ranges[i].end = 0;
+    workers.reserve(ranges.size()-1);
+    for (int i = 1; i < (int) ranges.size(); ++i)
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    jobStarted.notify_all();
+    for (std::vector<std::thread>::iterator worker = workers.begin(); worker != workers.end(); ++worker)
+        worker->join();
+}
+
+int ThreadPool::threadCount() const {
+    return (int) ranges.size();
+}
+
+void ThreadPool::parallelFor(int count, Task task, void *context) {
+    if (workers.empty() || count <= 1 || activePool == this) {
+        for (int i = 0; i < count; ++i)
+            task(context, i, 0);
+        return;
+    }
+    std::lock_guard<std::mutex> callLock(callMutex);
+    int threads = (int) ranges.size();
+    for (int i = 0; i < threads; ++i) {
+        std::lock_guard<std::mutex> lock(ranges[i].mutex);
+        ranges[i].begin = (int) ((long long) count*i/threads);
+        ranges[i].end = (int) ((long long) count*(i+1)/threads);
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        this->task = task;
+        this->context = context;
+        ++job;
+        busyWorkers = (int) workers.size();
+    }
+    jobStarted.notify_all();
+    runItems(0, task, context);
+    std::unique_lock<std::mutex> lock(stateMutex);
+    jobFinished.wait(lock, [this]() { return busyWorkers == 0; });
+}
+
+void ThreadPool::workerLoop(int thread) {
+    unsigned long long lastJob = 0;
+    for (;;) {
+        Task task;
+        void *context;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            jobStarted.wait(lock, [this, lastJob]() { return stopping || job != lastJob; });
+            if (stopping)
+                return;
+            lastJob = job;
+            task = this->task;
+            context = this->context;
+        }
+        runItems(thread, task, context);
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (!--busyWorkers)
+            jobFinished.notify_one();
+    }
+}
+
+void ThreadPool::runItems(int thread, Task task, void *context) {
+    const ThreadPool *prevPool = activePool;
+    activePool = this;
+    int index;
+    while (takeItem(index, thread))
+        task(context, index, thread);
+    activePool = prevPool;
+}
+
+bool ThreadPool::takeItem(int &index, int thread) {
+    Range &own = ranges[thread];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin < own.end) {
+            index = own.begin++;
+            return true;
+        }
+    }
+    // The own range is exhausted, so the upper half of the largest remaining range is taken over
+    for (;;) {
+        int victim = -1, most = 0;
+        for (int i = 0; i < (int) ranges.size(); ++i) {
+            if (i == thread)
+                continue;
+            std::lock_guard<std::mutex> lock(ranges[i].mutex);
+            if (ranges[i].end-ranges[i].begin > most)
+                victim = i, most = ranges[i].end-ranges[i].begin;
+        }
+        if (victim < 0)
+            return false;
+        int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+            if (ranges[victim].begin >= ranges[victim].end)
+                continue;
+            begin = ranges[victim].begin+(ranges[victim].end-ranges[victim].begin)/2;
+            end = ranges[victim].end;
+            ranges[victim].end = begin;
+        }
+        std::lock_guard<std::mutex> lock(own.mutex);
+        index = begin;
+        own.begin = begin+1;
+        own.end = end;
+        return true;
+    }
+}
+
+}
+
+#endif
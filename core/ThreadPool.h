@@ -0,0 +1,59 @@
+
+#pragma once
+
+#ifdef MSDFGEN_USE_CPP11
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Executor.h"
+
+namespace msdfgen {
+
+/**
+ * An executor with its own worker threads, which persist between calls, so a single pool may be reused for many shapes.
+ * The items of a parallel loop are divided into contiguous ranges, one per thread, and threads that finish their range early
+ * take over half of the remainder of another. The calling thread takes part in the work as thread 0.
+ * Calls from several threads at once are run one after another, and calls from within a task are run on the calling thread.
+ */
+class ThreadPool : public Executor {
+
+public:
+    /// Creates a pool of threadCount threads including the calling one, or as many as there are hardware threads if it is not positive.
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+    int threadCount() const;
+    void parallelFor(int count, Task task, void *context);
+
+private:
+    /// The items not yet taken by a thread, padded to avoid sharing a cache line with other ranges.
+    struct Range {
+        std::mutex mutex;
+        int begin, end;
+        char padding[64];
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<Range> ranges;
+    std::mutex callMutex;
+    std::mutex stateMutex;
+    std::condition_variable jobStarted, jobFinished;
+    Task task;
+    void *context;
+    unsigned long long job;
+    int busyWorkers;
+    bool stopping;
+
+    void workerLoop(int thread);
+    void runItems(int thread, Task task, void *context);
+    bool takeItem(int &index, int thread);
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+};
+
+}
+
+#endif
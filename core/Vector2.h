@@ -63,4 +63,144 @@ struct Vector2 {
 /// A vector may also represent a point, which shall be differentiated semantically using the alias Point2.
 typedef Vector2 Point2;
 
+inline Vector2::Vector2(double val) : x(val), y(val) { }
+
+inline Vector2::Vector2(double x, double y) : x(x), y(y) { }
+
+inline void Vector2::reset() {
+    x = 0, y = 0;
+}
+
+inline void Vector2::set(double x, double y) {
+    Vector2::x = x, Vector2::y = y;
+}
+
+inline double Vector2::length() const {
+    return sqrt(x*x+y*y);
+}
+
+inline double Vector2::direction() const {
+    return atan2(y, x);
+}
+
+inline Vector2 Vector2::normalize(bool allowZero) const {
+    double len = length();
+    if (len == 0)
+        return Vector2(0, !allowZero);
+    return Vector2(x/len, y/len);
+}
+
+inline Vector2 Vector2::getOrthogonal(bool polarity) const {
+    return polarity ? Vector2(-y, x) : Vector2(y, -x);
+}
+
+inline Vector2 Vector2::getOrthonormal(bool polarity, bool allowZero) const {
+    double len = length();
+    if (len == 0)
+        return polarity ? Vector2(0, !allowZero) : Vector2(0, -!allowZero);
+    return polarity ? Vector2(-y/len, x/len) : Vector2(y/len, -x/len);
+}
+
+inline Vector2 Vector2::project(const Vector2 &vector, bool positive) const {
+    Vector2 n = normalize(true);
+    double t = dotProduct(vector, n);
+    if (positive && t <= 0)
+        return Vector2();
+    return t*n;
+}
+
+inline Vector2::operator const void*() const {
+    return x || y ? this : NULL;
+}
+
+inline bool Vector2::operator!() const {
+    return !x && !y;
+}
+
+inline bool Vector2::operator==(const Vector2 &other) const {
+    return x == other.x && y == other.y;
+}
+
+inline bool Vector2::operator!=(const Vector2 &other) const {
+    return x != other.x || y != other.y;
+}
+
+inline Vector2 Vector2::operator+() const {
+    return *this;
+}
+
+inline Vector2 Vector2::operator-() const {
+    return Vector2(-x, -y);
+}
+
+inline Vector2 Vector2::operator+(const Vector2 &other) const {
+    return Vector2(x+other.x, y+other.y);
+}
+
+inline Vector2 Vector2::operator-(const Vector2 &other) const {
+    return Vector2(x-other.x, y-other.y);
+}
+
+inline Vector2 Vector2::operator*(const Vector2 &other) const {
+    return Vector2(x*other.x, y*other.y);
+}
+
+inline Vector2 Vector2::operator/(const Vector2 &other) const {
+    return Vector2(x/other.x, y/other.y);
+}
+
+inline Vector2 Vector2::operator*(double value) const {
+    return Vector2(x*value, y*value);
+}
+
+inline Vector2 Vector2::operator/(double value) const {
+    return Vector2(x/value, y/value);
+}
+
+inline Vector2 & Vector2::operator+=(const Vector2 &other) {
+    x += other.x, y += other.y;
+    return *this;
+}
+
+inline Vector2 & Vector2::operator-=(const Vector2 &other) {
+    x -= other.x, y -= other.y;
+    return *this;
+}
+
+inline Vector2 & Vector2::operator*=(const Vector2 &other) {
+    x *= other.x, y *= other.y;
+    return *this;
+}
+
+inline Vector2 & Vector2::operator/=(const Vector2 &other) {
+    x /= other.x, y /= other.y;
+    return *this;
+}
+
+inline Vector2 & Vector2::operator*=(double value) {
+    x *= value, y *= value;
+    return *this;
+}
+
+inline Vector2 & Vector2::operator/=(double value) {
+    x /= value, y /= value;
+    return *this;
+}
+
+inline double dotProduct(const Vector2 &a, const Vector2 &b) {
+    return a.x*b.x+a.y*b.y;
+}
+
+inline double crossProduct(const Vector2 &a, const Vector2 &b) {
+    return a.x*b.y-a.y*b.x;
+}
+
+inline Vector2 operator*(double value, const Vector2 &vector) {
+    return Vector2(value*vector.x, value*vector.y);
+}
+
+inline Vector2 operator/(double value, const Vector2 &vector) {
+    return Vector2(value/vector.x, value/vector.y);
+}
+
 }
@@ -0,0 +1,194 @@
+
+#pragma once
+
+#include "DoubleBatch.hpp"
+#include "FloatBatch.hpp"
+#include "CompiledShape.h"
+#include "equation-solver.h"
+
+namespace msdfgen {
+
+// These kernels compute the signed distances between an edge and MSDFGEN_BATCH_SIZE points (x, y) at once, in the precision of the Batch type (DoubleBatch or FloatBatch).
+// With DoubleBatch, each lane's result is bit-identical to CompiledShape::signedDistance for that point, so they replicate its operations exactly.
+
+/// Returns ±magnitude according to nonZeroSign(signSource).
+template <class Batch>
+inline Batch batchNonZeroSign(const Batch &signSource, const Batch &magnitude) {
+    return select(signSource > 0, magnitude, -magnitude);
+}
+
+/// Returns |dotProduct(unitDirection, (x, y).normalize())|.
+template <class Batch>
+inline Batch batchAlignment(const Vector2 &unitDirection, const Batch &x, const Batch &y) {
+    Batch length = sqrt(x*x+y*y);
+    typename Batch::Mask zero = length == 0;
+    Batch nx = select(zero, Batch(0), x/length);
+    Batch ny = select(zero, Batch(1), y/length);
+    return fabs(unitDirection.x*nx+unitDirection.y*ny);
+}
+
+template <class Batch>
+inline void linearBatchSignedDistance(Batch &distance, Batch &dot, Batch &param, const CompiledShape::LinearEdges &edges, int index, const Batch &x, const Batch &y) {
+    const Point2 &p0 = edges.p0[index], &p1 = edges.p1[index];
+    const Vector2 &ab = edges.ab[index];
+    const Vector2 &orthonormal = edges.orthonormal[index];
+    Batch aqx = x-p0.x, aqy = y-p0.y;
+    param = (aqx*ab.x+aqy*ab.y)/edges.abab[index];
+    typename Batch::Mask farHalf = param > .5;
+    Batch eqx = select(farHalf, Batch(p1.x), Batch(p0.x))-x;
+    Batch eqy = select(farHalf, Batch(p1.y), Batch(p0.y))-y;
+    Batch endpointDistance = sqrt(eqx*eqx+eqy*eqy);
+    Batch orthoDistance = orthonormal.x*aqx+orthonormal.y*aqy;
+    typename Batch::Mask orthogonal = (param > 0)&(param < 1)&(fabs(orthoDistance) < endpointDistance);
+    distance = select(orthogonal, orthoDistance, batchNonZeroSign(aqx*ab.y-aqy*ab.x, endpointDistance));
+    dot = select(orthogonal, Batch(0), batchAlignment(edges.unitDirection[index], eqx, eqy));
+}
+
+template <class Batch>
+inline void quadraticBatchSignedDistance(Batch &distance, Batch &dot, Batch &param, const CompiledShape::QuadraticEdges &edges, int index, const Batch &x, const Batch &y, int lanes) {
+    const Point2 &p0 = edges.p0[index], &p1 = edges.p1[index], &p2 = edges.p2[index];
+    const Vector2 &ab = edges.ab[index], &br = edges.br[index], &p12 = edges.p12[index];
+    Batch qax = p0.x-x, qay = p0.y-y;
+    double c[MSDFGEN_BATCH_SIZE], d[MSDFGEN_BATCH_SIZE];
+    (edges.c[index]+(qax*br.x+qay*br.y)).store(c);
+    (qax*ab.x+qay*ab.y).store(d);
+    // The equation is solved separately for each lane and the solutions regrouped so that the i-th solutions of all lanes form a batch
+    double t[3][MSDFGEN_BATCH_SIZE];
+    int solutions[MSDFGEN_BATCH_SIZE];
+    int maxSolutions = 0;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+        double laneT[3];
+        solutions[i] = lanes&(1<<i) ? solveCubic(laneT, edges.a[index], edges.b[index], c[i], d[i]) : 0;
+        for (int j = 0; j < 3; ++j)
+            t[j][i] = j < solutions[i] ? laneT[j] : 0;
+        if (solutions[i] > maxSolutions)
+            maxSolutions = solutions[i];
+    }
+
+    Vector2 epDir = edges.startDirection[index];
+    Batch minDistance = batchNonZeroSign(epDir.x*qay-epDir.y*qax, sqrt(qax*qax+qay*qay)); // distance from A
+    param = -(qax*epDir.x+qay*epDir.y)/edges.startDirectionSquared[index];
+    Batch bqx = p2.x-x, bqy = p2.y-y;
+    {
+        epDir = edges.endDirection[index];
+        Batch endpointDistance = sqrt(bqx*bqx+bqy*bqy); // distance from B
+        typename Batch::Mask nearer = endpointDistance < fabs(minDistance);
+        minDistance = select(nearer, batchNonZeroSign(epDir.x*bqy-epDir.y*bqx, endpointDistance), minDistance);
+        param = select(nearer, ((x-p1.x)*epDir.x+(y-p1.y)*epDir.y)/edges.endDirectionSquared[index], param);
+    }
+    for (int i = 0; i < maxSolutions; ++i) {
+        Batch ti = Batch::load(t[i]);
+        Batch qex = p0.x+2*ti*ab.x+ti*ti*br.x-x;
+        Batch qey = p0.y+2*ti*ab.y+ti*ti*br.y-y;
+        Batch solutionDistance = sqrt(qex*qex+qey*qey);
+        typename Batch::Mask nearer = (ti > 0)&(ti < 1)&(solutionDistance <= fabs(minDistance));
+        if (nearer.any()) {
+            Batch tangentX = (1-ti)*ab.x+ti*p12.x;
+            Batch tangentY = (1-ti)*ab.y+ti*p12.y;
+            typename Batch::Mask zeroTangent = (tangentX == 0)&(tangentY == 0);
+            tangentX = select(zeroTangent, Batch(edges.p02[index].x), tangentX);
+            tangentY = select(zeroTangent, Batch(edges.p02[index].y), tangentY);
+            minDistance = select(nearer, batchNonZeroSign(tangentX*qey-tangentY*qex, solutionDistance), minDistance);
+            param = select(nearer, ti, param);
+        }
+    }
+
+    distance = minDistance;
+    dot = select((param >= 0)&(param <= 1), Batch(0), select(param < .5,
+        batchAlignment(edges.startUnitDirection[index], qax, qay),
+        batchAlignment(edges.endUnitDirection[index], bqx, bqy)
+    ));
+}
+
+template <class Batch>
+inline void cubicBatchSignedDistance(Batch &distance, Batch &dot, Batch &param, const CompiledShape::CubicEdges &edges, int index, const Batch &x, const Batch &y) {
+    const Point2 &p0 = edges.p0[index], &p3 = edges.p3[index];
+    const Vector2 &ab = edges.ab[index], &br = edges.br[index], &as = edges.as[index];
+    const Vector2 &p12 = edges.p12[index], &p23 = edges.p23[index];
+    Batch qax = p0.x-x, qay = p0.y-y;
+
+    Vector2 epDir = edges.startDirection[index];
+    Batch minDistance = batchNonZeroSign(epDir.x*qay-epDir.y*qax, sqrt(qax*qax+qay*qay)); // distance from A
+    param = -(qax*epDir.x+qay*epDir.y)/edges.startDirectionSquared[index];
+    Batch bqx = p3.x-x, bqy = p3.y-y;
+    {
+        epDir = edges.endDirection[index];
+        Batch endpointDistance = sqrt(bqx*bqx+bqy*bqy); // distance from B
+        typename Batch::Mask nearer = endpointDistance < fabs(minDistance);
+        minDistance = select(nearer, batchNonZeroSign(epDir.x*bqy-epDir.y*bqx, endpointDistance), minDistance);
+        param = select(nearer, ((epDir.x-bqx)*epDir.x+(epDir.y-bqy)*epDir.y)/edges.endDirectionSquared[index], param);
+    }
+    // Iterative minimum distance search, where lanes that leave the interval of the edge stop taking part
+    for (int i = 0; i <= MSDFGEN_CUBIC_SEARCH_STARTS; ++i) {
+        double t0 = (double) i/MSDFGEN_CUBIC_SEARCH_STARTS;
+        Batch t(t0);
+        Batch qex = qax+3*t0*ab.x+3*t0*t0*br.x+t0*t0*t0*as.x;
+        Batch qey = qay+3*t0*ab.y+3*t0*t0*br.y+t0*t0*t0*as.y;
+        typename Batch::Mask active = t == t0;
+        for (int step = 0; step < MSDFGEN_CUBIC_SEARCH_STEPS; ++step) {
+            // Improve t
+            Batch d1x = 3*as.x*t*t+6*br.x*t+3*ab.x;
+            Batch d1y = 3*as.y*t*t+6*br.y*t+3*ab.y;
+            Batch d2x = 6*as.x*t+6*br.x;
+            Batch d2y = 6*as.y*t+6*br.y;
+            t = t-(qex*d1x+qey*d1y)/((d1x*d1x+d1y*d1y)+(qex*d2x+qey*d2y));
+            active = active&!((t <= 0)|(t >= 1));
+            if (!active.any())
+                break;
+            qex = qax+3*t*ab.x+3*t*t*br.x+t*t*t*as.x;
+            qey = qay+3*t*ab.y+3*t*t*br.y+t*t*t*as.y;
+            Batch searchDistance = sqrt(qex*qex+qey*qey);
+            typename Batch::Mask nearer = active&(searchDistance < fabs(minDistance));
+            if (nearer.any()) {
+                Batch tangentX = (1-t)*((1-t)*ab.x+t*p12.x)+t*((1-t)*p12.x+t*p23.x);
+                Batch tangentY = (1-t)*((1-t)*ab.y+t*p12.y)+t*((1-t)*p12.y+t*p23.y);
+                minDistance = select(nearer, batchNonZeroSign(tangentX*qey-tangentY*qex, searchDistance), minDistance);
+                param = select(nearer, t, param);
+            }
+        }
+    }
+
+    distance = minDistance;
+    dot = select((param >= 0)&(param <= 1), Batch(0), select(param < .5,
+        batchAlignment(edges.startUnitDirection[index], qax, qay),
+        batchAlignment(edges.endUnitDirection[index], bqx, bqy)
+    ));
+}
+
+/// Computes the signed distances between an edge of a compiled shape and MSDFGEN_BATCH_SIZE points at once. Only the lanes set in the bit field lanes are guaranteed to be valid.
+template <class Batch>
+inline void batchSignedDistance(Batch &distance, Batch &dot, Batch &param, const CompiledShape &shape, int edge, const Batch &x, const Batch &y, int lanes) {
+    switch (shape.edges[edge].type) {
+        case CompiledShape::LINEAR_EDGE:
+            linearBatchSignedDistance(distance, dot, param, shape.linearEdges, shape.edges[edge].index, x, y);
+            return;
+        case CompiledShape::QUADRATIC_EDGE:
+            quadraticBatchSignedDistance(distance, dot, param, shape.quadraticEdges, shape.edges[edge].index, x, y, lanes);
+            return;
+        case CompiledShape::CUBIC_EDGE:
+            // Approximated cubic segments are evaluated separately for each lane
+            if (!shape.cubicEdges.pieceCount[shape.edges[edge].index]) {
+                cubicBatchSignedDistance(distance, dot, param, shape.cubicEdges, shape.edges[edge].index, x, y);
+                return;
+            }
+            break;
+        case CompiledShape::GENERIC_EDGE:;
+    }
+    double px[MSDFGEN_BATCH_SIZE], py[MSDFGEN_BATCH_SIZE];
+    double laneDistance[MSDFGEN_BATCH_SIZE], laneDot[MSDFGEN_BATCH_SIZE], laneParam[MSDFGEN_BATCH_SIZE];
+    x.store(px);
+    y.store(py);
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+        SignedDistance laneSignedDistance;
+        laneParam[i] = 0;
+        if (lanes&(1<<i))
+            laneSignedDistance = shape.signedDistance(edge, Point2(px[i], py[i]), laneParam[i]);
+        laneDistance[i] = laneSignedDistance.distance;
+        laneDot[i] = laneSignedDistance.dot;
+    }
+    distance = Batch::load(laneDistance);
+    dot = Batch::load(laneDot);
+    param = Batch::load(laneParam);
+}
+
+}
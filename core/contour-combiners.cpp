@@ -5,16 +5,6 @@
 
 namespace msdfgen {
 
-static void initDistance(double &distance) {
-    distance = SignedDistance::INFINITE.distance;
-}
-
-static void initDistance(MultiDistance &distance) {
-    distance.r = SignedDistance::INFINITE.distance;
-    distance.g = SignedDistance::INFINITE.distance;
-    distance.b = SignedDistance::INFINITE.distance;
-}
-
 static double resolveDistance(double distance) {
     return distance;
 }
@@ -26,6 +16,9 @@ static double resolveDistance(const MultiDistance &distance) {
 template <class EdgeSelector>
 SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const Shape &shape) { }
 
+template <class EdgeSelector>
+SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const CompiledShape &) { }
+
 template <class EdgeSelector>
 void SimpleContourCombiner<EdgeSelector>::reset(const Point2 &p) {
     shapeEdgeSelector.reset(p);
@@ -52,8 +45,13 @@ OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const Shape
     for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
         windings.push_back(contour->winding());
     edgeSelectors.resize(shape.contours.size());
+    contourDistances.resize(shape.contours.size());
+    contourScalarDistances.resize(shape.contours.size());
 }
 
+template <class EdgeSelector>
+OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const CompiledShape &shape) : windings(shape.windings), edgeSelectors(shape.windings.size()), contourDistances(shape.windings.size()), contourScalarDistances(shape.windings.size()) { }
+
 template <class EdgeSelector>
 void OverlappingContourCombiner<EdgeSelector>::reset(const Point2 &p) {
     this->p = p;
@@ -67,8 +65,13 @@ EdgeSelector & OverlappingContourCombiner<EdgeSelector>::edgeSelector(int i) {
 }
 
 template <class EdgeSelector>
-typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingContourCombiner<EdgeSelector>::distance() const {
+typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingContourCombiner<EdgeSelector>::distance() {
     int contourCount = (int) edgeSelectors.size();
+    // A single contour always forms the border, and the result below reduces to its distance
+    if (contourCount == 1)
+        return edgeSelectors[0].distance();
+
+    // Each contour's distance is resolved exactly once, while it is merged into the selectors of the whole shape and of the contours enclosing the point
     EdgeSelector shapeEdgeSelector;
     EdgeSelector innerEdgeSelector;
     EdgeSelector outerEdgeSelector;
@@ -76,11 +79,12 @@ typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingConto
     innerEdgeSelector.reset(p);
     outerEdgeSelector.reset(p);
     for (int i = 0; i < contourCount; ++i) {
-        DistanceType edgeDistance = edgeSelectors[i].distance();
+        contourDistances[i] = edgeSelectors[i].distance();
+        double scalarDistance = contourScalarDistances[i] = resolveDistance(contourDistances[i]);
         shapeEdgeSelector.merge(edgeSelectors[i]);
-        if (windings[i] > 0 && resolveDistance(edgeDistance) >= 0)
+        if (windings[i] > 0 && scalarDistance >= 0)
             innerEdgeSelector.merge(edgeSelectors[i]);
-        if (windings[i] < 0 && resolveDistance(edgeDistance) <= 0)
+        if (windings[i] < 0 && scalarDistance <= 0)
             outerEdgeSelector.merge(edgeSelectors[i]);
     }
 
@@ -90,37 +94,37 @@ typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingConto
     double innerScalarDistance = resolveDistance(innerDistance);
     double outerScalarDistance = resolveDistance(outerDistance);
     DistanceType distance;
-    initDistance(distance);
+    double scalarDistance;
 
+    // Contours are only considered by their cached scalar distances, and those which cannot beat the current candidate are skipped
     int winding = 0;
     if (innerScalarDistance >= 0 && fabs(innerScalarDistance) <= fabs(outerScalarDistance)) {
         distance = innerDistance;
+        scalarDistance = innerScalarDistance;
         winding = 1;
         for (int i = 0; i < contourCount; ++i)
-            if (windings[i] > 0) {
-                DistanceType contourDistance = edgeSelectors[i].distance();
-                if (fabs(resolveDistance(contourDistance)) < fabs(outerScalarDistance) && resolveDistance(contourDistance) > resolveDistance(distance))
-                    distance = contourDistance;
+            if (windings[i] > 0 && contourScalarDistances[i] > scalarDistance && fabs(contourScalarDistances[i]) < fabs(outerScalarDistance)) {
+                distance = contourDistances[i];
+                scalarDistance = contourScalarDistances[i];
             }
     } else if (outerScalarDistance <= 0 && fabs(outerScalarDistance) < fabs(innerScalarDistance)) {
         distance = outerDistance;
+        scalarDistance = outerScalarDistance;
         winding = -1;
         for (int i = 0; i < contourCount; ++i)
-            if (windings[i] < 0) {
-                DistanceType contourDistance = edgeSelectors[i].distance();
-                if (fabs(resolveDistance(contourDistance)) < fabs(innerScalarDistance) && resolveDistance(contourDistance) < resolveDistance(distance))
-                    distance = contourDistance;
+            if (windings[i] < 0 && contourScalarDistances[i] < scalarDistance && fabs(contourScalarDistances[i]) < fabs(innerScalarDistance)) {
+                distance = contourDistances[i];
+                scalarDistance = contourScalarDistances[i];
             }
     } else
         return shapeDistance;
 
     for (int i = 0; i < contourCount; ++i)
-        if (windings[i] != winding) {
-            DistanceType contourDistance = edgeSelectors[i].distance();
-            if (resolveDistance(contourDistance)*resolveDistance(distance) >= 0 && fabs(resolveDistance(contourDistance)) < fabs(resolveDistance(distance)))
-                distance = contourDistance;
+        if (windings[i] != winding && fabs(contourScalarDistances[i]) < fabs(scalarDistance) && contourScalarDistances[i]*scalarDistance >= 0) {
+            distance = contourDistances[i];
+            scalarDistance = contourScalarDistances[i];
         }
-    if (resolveDistance(distance) == resolveDistance(shapeDistance))
+    if (scalarDistance == resolveDistance(shapeDistance))
         distance = shapeDistance;
     return distance;
 }
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Shape.h"
+#include "CompiledShape.h"
 #include "edge-selectors.h"
 
 namespace msdfgen {
@@ -15,6 +16,7 @@ public:
     typedef typename EdgeSelector::DistanceType DistanceType;
 
     explicit SimpleContourCombiner(const Shape &shape);
+    explicit SimpleContourCombiner(const CompiledShape &shape);
     void reset(const Point2 &p);
     EdgeSelector & edgeSelector(int i);
     DistanceType distance() const;
@@ -33,14 +35,18 @@ public:
     typedef typename EdgeSelector::DistanceType DistanceType;
 
     explicit OverlappingContourCombiner(const Shape &shape);
+    explicit OverlappingContourCombiner(const CompiledShape &shape);
     void reset(const Point2 &p);
     EdgeSelector & edgeSelector(int i);
-    DistanceType distance() const;
+    DistanceType distance();
 
 private:
     Point2 p;
     std::vector<int> windings;
     std::vector<EdgeSelector> edgeSelectors;
+    // Preallocated storage of the contours' distances during the distance computation
+    std::vector<DistanceType> contourDistances;
+    std::vector<double> contourScalarDistances;
 
 };
 
@@ -27,6 +27,26 @@ void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge
     }
 }
 
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex) {
+    if (isEdgeRelevant(cache, shape, edgeIndex)) {
+        double dummy;
+        SignedDistance distance = shape.signedDistance(edgeIndex, p, dummy);
+        addEdge(cache, shape, edgeIndex, distance, dummy);
+    }
+}
+
+bool TrueDistanceSelector::isEdgeRelevant(const EdgeCache &cache, const CompiledShape &, int) const {
+    double delta = DISTANCE_DELTA_FACTOR*(p-cache.point).length();
+    return cache.absDistance-delta <= fabs(minDistance.distance);
+}
+
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &, int, const SignedDistance &distance, double) {
+    if (distance < minDistance)
+        minDistance = distance;
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+}
+
 void TrueDistanceSelector::merge(const TrueDistanceSelector &other) {
     if (other.minDistance < minDistance)
         minDistance = other.minDistance;
@@ -36,6 +56,10 @@ TrueDistanceSelector::DistanceType TrueDistanceSelector::distance() const {
     return minDistance.distance;
 }
 
+double TrueDistanceSelector::searchRadius() const {
+    return fabs(minDistance.distance);
+}
+
 PseudoDistanceSelectorBase::EdgeCache::EdgeCache() : absDistance(0), aDomainDistance(0), bDomainDistance(0), aPseudoDistance(0), bPseudoDistance(0) { }
 
 bool PseudoDistanceSelectorBase::getPseudoDistance(double &distance, const Vector2 &ep, const Vector2 &edgeDir) {
@@ -119,6 +143,11 @@ SignedDistance PseudoDistanceSelectorBase::trueDistance() const {
     return minTrueDistance;
 }
 
+double PseudoDistanceSelectorBase::searchRadius() const {
+    // Pseudo-distances are only accepted below the true distance found so far
+    return fabs(minTrueDistance.distance);
+}
+
 void PseudoDistanceSelector::reset(const Point2 &p) {
     double delta = DISTANCE_DELTA_FACTOR*(p-this->p).length();
     PseudoDistanceSelectorBase::reset(delta);
@@ -158,6 +187,44 @@ void PseudoDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEd
     }
 }
 
+void PseudoDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex) {
+    if (isEdgeRelevant(cache, shape, edgeIndex)) {
+        double param;
+        SignedDistance distance = shape.signedDistance(edgeIndex, p, param);
+        addEdge(cache, shape, edgeIndex, distance, param);
+    }
+}
+
+bool PseudoDistanceSelector::isEdgeRelevant(const EdgeCache &cache, const CompiledShape &shape, int edgeIndex) const {
+    return isEdgeRelevant(cache, shape.edges[edgeIndex].segment, p);
+}
+
+void PseudoDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex, const SignedDistance &distance, double param) {
+    const CompiledShape::Edge &edge = shape.edges[edgeIndex];
+    addEdgeTrueDistance(edge.segment, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+
+    Vector2 ap = p-edge.point[0];
+    Vector2 bp = p-edge.point[1];
+    double add = dotProduct(ap, edge.bisector[0]);
+    double bdd = -dotProduct(bp, edge.bisector[1]);
+    if (add > 0) {
+        double pd = distance.distance;
+        if (getPseudoDistance(pd, ap, -edge.direction[0]))
+            addEdgePseudoDistance(pd = -pd);
+        cache.aPseudoDistance = pd;
+    }
+    if (bdd > 0) {
+        double pd = distance.distance;
+        if (getPseudoDistance(pd, bp, edge.direction[1]))
+            addEdgePseudoDistance(pd);
+        cache.bPseudoDistance = pd;
+    }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
+}
+
 PseudoDistanceSelector::DistanceType PseudoDistanceSelector::distance() const {
     return computeDistance(p);
 }
@@ -225,6 +292,67 @@ void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdg
     }
 }
 
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex) {
+    if (isEdgeRelevant(cache, shape, edgeIndex)) {
+        double param;
+        SignedDistance distance = shape.signedDistance(edgeIndex, p, param);
+        addEdge(cache, shape, edgeIndex, distance, param);
+    }
+}
+
+bool MultiDistanceSelector::isEdgeRelevant(const EdgeCache &cache, const CompiledShape &shape, int edgeIndex) const {
+    const CompiledShape::Edge &edge = shape.edges[edgeIndex];
+    return (
+        (edge.color&RED && r.isEdgeRelevant(cache, edge.segment, p)) ||
+        (edge.color&GREEN && g.isEdgeRelevant(cache, edge.segment, p)) ||
+        (edge.color&BLUE && b.isEdgeRelevant(cache, edge.segment, p))
+    );
+}
+
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex, const SignedDistance &distance, double param) {
+    const CompiledShape::Edge &edge = shape.edges[edgeIndex];
+    if (edge.color&RED)
+        r.addEdgeTrueDistance(edge.segment, distance, param);
+    if (edge.color&GREEN)
+        g.addEdgeTrueDistance(edge.segment, distance, param);
+    if (edge.color&BLUE)
+        b.addEdgeTrueDistance(edge.segment, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+
+    Vector2 ap = p-edge.point[0];
+    Vector2 bp = p-edge.point[1];
+    double add = dotProduct(ap, edge.bisector[0]);
+    double bdd = -dotProduct(bp, edge.bisector[1]);
+    if (add > 0) {
+        double pd = distance.distance;
+        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, ap, -edge.direction[0])) {
+            pd = -pd;
+            if (edge.color&RED)
+                r.addEdgePseudoDistance(pd);
+            if (edge.color&GREEN)
+                g.addEdgePseudoDistance(pd);
+            if (edge.color&BLUE)
+                b.addEdgePseudoDistance(pd);
+        }
+        cache.aPseudoDistance = pd;
+    }
+    if (bdd > 0) {
+        double pd = distance.distance;
+        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, bp, edge.direction[1])) {
+            if (edge.color&RED)
+                r.addEdgePseudoDistance(pd);
+            if (edge.color&GREEN)
+                g.addEdgePseudoDistance(pd);
+            if (edge.color&BLUE)
+                b.addEdgePseudoDistance(pd);
+        }
+        cache.bPseudoDistance = pd;
+    }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
+}
+
 void MultiDistanceSelector::merge(const MultiDistanceSelector &other) {
     r.merge(other.r);
     g.merge(other.g);
@@ -248,6 +376,19 @@ SignedDistance MultiDistanceSelector::trueDistance() const {
     return distance;
 }
 
+double MultiDistanceSelector::searchRadius() const {
+    // Channels without any edges remain at infinite distance and do not constrain the search, unless no channel has been resolved yet
+    double infiniteRadius = fabs(SignedDistance::INFINITE.distance);
+    double radius = -1;
+    if (r.searchRadius() < infiniteRadius)
+        radius = r.searchRadius();
+    if (g.searchRadius() < infiniteRadius && g.searchRadius() > radius)
+        radius = g.searchRadius();
+    if (b.searchRadius() < infiniteRadius && b.searchRadius() > radius)
+        radius = b.searchRadius();
+    return radius >= 0 ? radius : infiniteRadius;
+}
+
 MultiAndTrueDistanceSelector::DistanceType MultiAndTrueDistanceSelector::distance() const {
     MultiDistance multiDistance = MultiDistanceSelector::distance();
     MultiAndTrueDistance mtd;
@@ -4,6 +4,7 @@
 #include "Vector2.h"
 #include "SignedDistance.h"
 #include "edge-segments.h"
+#include "CompiledShape.h"
 
 namespace msdfgen {
 
@@ -29,8 +30,16 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Equivalent to the above for an edge of a compiled shape.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex);
+    /// Determines whether an edge of a compiled shape needs to be evaluated, which is otherwise skipped by addEdge.
+    bool isEdgeRelevant(const EdgeCache &cache, const CompiledShape &shape, int edgeIndex) const;
+    /// Adds an edge of a compiled shape whose signed distance from the current point has already been computed.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     void merge(const TrueDistanceSelector &other);
     DistanceType distance() const;
+    /// Returns the distance beyond which edges cannot affect the result for the current point.
+    double searchRadius() const;
 
 private:
     Point2 p;
@@ -60,6 +69,7 @@ public:
     void merge(const PseudoDistanceSelectorBase &other);
     double computeDistance(const Point2 &p) const;
     SignedDistance trueDistance() const;
+    double searchRadius() const;
 
 private:
     SignedDistance minTrueDistance;
@@ -76,8 +86,16 @@ class PseudoDistanceSelector : public PseudoDistanceSelectorBase {
 public:
     typedef double DistanceType;
 
+    using PseudoDistanceSelectorBase::isEdgeRelevant;
+
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Equivalent to the above for an edge of a compiled shape.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex);
+    /// Determines whether an edge of a compiled shape needs to be evaluated, which is otherwise skipped by addEdge.
+    bool isEdgeRelevant(const EdgeCache &cache, const CompiledShape &shape, int edgeIndex) const;
+    /// Adds an edge of a compiled shape whose signed distance from the current point has already been computed.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     DistanceType distance() const;
 
 private:
@@ -94,9 +112,16 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Equivalent to the above for an edge of a compiled shape.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex);
+    /// Determines whether an edge of a compiled shape needs to be evaluated, which is otherwise skipped by addEdge.
+    bool isEdgeRelevant(const EdgeCache &cache, const CompiledShape &shape, int edgeIndex) const;
+    /// Adds an edge of a compiled shape whose signed distance from the current point has already been computed.
+    void addEdge(EdgeCache &cache, const CompiledShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     void merge(const MultiDistanceSelector &other);
     DistanceType distance() const;
     SignedDistance trueDistance() const;
+    double searchRadius() const;
 
 private:
     Point2 p;
@@ -0,0 +1,54 @@
+
+#pragma once
+
+#include <cstdlib>
+#include "EdgeGrid.h"
+#include "Scanline.h"
+#include "Executor.h"
+#include "msdf-error-correction.h"
+
+namespace msdfgen {
+
+/// The order in which the distance field generator visits the pixels.
+enum PixelTraversal {
+    /// Strips of rows in alternating direction, evenly divided among threads.
+    ROW_TRAVERSAL,
+    /// Small tiles in the order of a Hilbert curve, handed to threads as they become available.
+    TILE_TRAVERSAL
+};
+
+/// The configuration of the distance field generator algorithm.
+struct GeneratorConfig {
+    /// Specifies whether to use the version of the algorithm that supports overlapping contours with the same winding. May be set to false to improve performance when no such contours are present.
+    bool overlapSupport;
+    /// An optional spatial index of the shape's edges, which speeds up the generation for shapes with many edges without affecting the result. Must be built from the same shape.
+    const EdgeGrid *edgeGrid;
+    /// Specifies whether to skip the evaluation of pixels provably farther from the shape than half of the range and output their saturated values (0 or 1) in all channels instead.
+    bool narrowBand;
+    /// If positive, cells of pixels in narrow band mode which contain no edge and whose distances at their centers and the midpoints of their sides deviate from bilinear interpolation between their corners by at most this distance in shape units are interpolated instead of computed per pixel.
+    double interpolationTolerance;
+    /// If positive, cubic segments are approximated by quadratic pieces which deviate from them by at most this distance in shape units. This speeds up the generation for shapes with cubic segments at the cost of distances inexact by up to the tolerance.
+    double cubicTolerance;
+    /// Specifies whether to compute the distances of multiple pixels at once in single precision, which is faster but only accurate for shapes with moderate coordinates, such as glyphs in normalized units. Not used in narrow band mode.
+    bool singlePrecision;
+    /// The order in which the pixels are visited, which affects the performance but not the result. Not used in narrow band mode.
+    PixelTraversal traversal;
+    /// An optional executor, such as a ThreadPool, which runs the parallel loops of the generator instead of OpenMP (if enabled). May be shared by multiple configurations and reused between calls.
+    Executor *executor;
+    /// Specifies whether to fix the signs of the distances to match the shape's fill by a scanline pass (see distanceSignCorrection), after which multi-channel distance fields are error corrected again.
+    bool scanlinePass;
+    /// The fill rule of the scanline pass.
+    FillRule fillRule;
+
+    inline explicit GeneratorConfig(bool overlapSupport = true) : overlapSupport(overlapSupport), edgeGrid(NULL), narrowBand(false), interpolationTolerance(0), cubicTolerance(0), singlePrecision(false), traversal(ROW_TRAVERSAL), executor(NULL), scanlinePass(false), fillRule(FILL_NONZERO) { }
+};
+
+/// The configuration of the multi-channel distance field generator algorithm.
+struct MSDFGeneratorConfig : GeneratorConfig {
+    /// The threshold of the error correction pass, which is skipped if it is not positive.
+    double edgeThreshold;
+
+    inline explicit MSDFGeneratorConfig(bool overlapSupport = true, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD) : GeneratorConfig(overlapSupport), edgeThreshold(edgeThreshold) { }
+};
+
+}
@@ -3,7 +3,6 @@
 
 #include <cstring>
 #include <vector>
-#include <utility>
 #include "arithmetics.hpp"
 #include "equation-solver.h"
 #include "bitmap-interpolation.hpp"
@@ -11,6 +10,9 @@
 #include "contour-combiners.h"
 #include "ShapeDistanceFinder.h"
 
+// The number of rows processed by each task of the edge artifact patcher
+#define EDGE_ARTIFACT_BAND_HEIGHT 16
+
 namespace msdfgen {
 
 static bool isHotspot(float am, float bm, float xm) {
@@ -70,35 +72,36 @@ static int findDiagonalHotspots(double t[6], const float *a, const float *b, con
     return found;
 }
 
-template <int N>
-void findHotspots(std::vector<Point2> &hotspots, const BitmapConstRef<float, N> &sdf) {
+template <int N, class HotspotHandler>
+void findHotspots(HotspotHandler &handler, const BitmapConstRef<float, N> &sdf, int rowOffset, int y0, int y1) {
     // All hotspots intersect either the horizontal, vertical, or diagonal line that connects neighboring texels
+    // Only hotspots whose closest texel lies in rows y0 to y1-1 are passed to the handler, with Y coordinates offset by rowOffset
     // Horizontal:
-    for (int y = 0; y < sdf.height; ++y) {
+    for (int y = y0; y < y1; ++y) {
         const float *left = sdf(0, y);
         const float *right = sdf(1, y);
         for (int x = 0; x < sdf.width-1; ++x) {
             double t[3];
             int found = findLinearHotspots(t, left, right);
             for (int i = 0; i < found; ++i)
-                hotspots.push_back(Point2(x+.5+t[i], y+.5));
+                handler(Point2(x+.5+t[i], (y+rowOffset)+.5));
             left += N, right += N;
         }
     }
     // Vertical:
-    for (int y = 0; y < sdf.height-1; ++y) {
+    for (int y = max(y0-1, 0); y < y1 && y < sdf.height-1; ++y) {
         const float *bottom = sdf(0, y);
         const float *top = sdf(0, y+1);
         for (int x = 0; x < sdf.width; ++x) {
             double t[3];
             int found = findLinearHotspots(t, bottom, top);
             for (int i = 0; i < found; ++i)
-                hotspots.push_back(Point2(x+.5, y+.5+t[i]));
+                handler(Point2(x+.5, (y+rowOffset)+.5+t[i]));
             bottom += N, top += N;
         }
     }
     // Diagonal:
-    for (int y = 0; y < sdf.height-1; ++y) {
+    for (int y = max(y0-1, 0); y < y1 && y < sdf.height-1; ++y) {
         const float *lb = sdf(0, y);
         const float *rb = sdf(1, y);
         const float *lt = sdf(0, y+1);
@@ -108,67 +111,178 @@ void findHotspots(std::vector<Point2> &hotspots, const BitmapConstRef<float, N>
             int found = 0;
             found = findDiagonalHotspots(t, lb, rb, lt, rt);
             for (int i = 0; i < found; ++i)
-                hotspots.push_back(Point2(x+.5+t[i], y+.5+t[i]));
+                handler(Point2(x+.5+t[i], (y+rowOffset)+.5+t[i]));
             found = findDiagonalHotspots(t, lt, rt, lb, rb);
             for (int i = 0; i < found; ++i)
-                hotspots.push_back(Point2(x+.5+t[i], y+1.5-t[i]));
+                handler(Point2(x+.5+t[i], (y+rowOffset)+1.5-t[i]));
             lb += N, rb += N, lt += N, rt += N;
         }
     }
 }
 
+/// Interpolates the distance field at pos as if the color channels of texel (x, y) were set to their median.
+template <int N>
+static void interpolateFlattened(float *output, const BitmapConstRef<float, N> &sdf, Point2 pos, int x, int y) {
+    float flattened[N];
+    memcpy(flattened, sdf(x, y), N*sizeof(float));
+    float med = median(flattened[0], flattened[1], flattened[2]);
+    flattened[0] = med, flattened[1] = med, flattened[2] = med;
+    pos -= .5;
+    int l = (int) floor(pos.x);
+    int b = (int) floor(pos.y);
+    int r = l+1;
+    int t = b+1;
+    double lr = pos.x-l;
+    double bt = pos.y-b;
+    l = clamp(l, sdf.width-1), r = clamp(r, sdf.width-1);
+    b = clamp(b, sdf.height-1), t = clamp(t, sdf.height-1);
+    const float *lb = l == x && b == y ? flattened : sdf(l, b);
+    const float *rb = r == x && b == y ? flattened : sdf(r, b);
+    const float *lt = l == x && t == y ? flattened : sdf(l, t);
+    const float *rt = r == x && t == y ? flattened : sdf(r, t);
+    for (int i = 0; i < N; ++i)
+        output[i] = mix(mix(lb[i], rb[i], lr), mix(lt[i], rt[i], lr), bt);
+}
+
+/**
+ * Finds and flattens edge artifacts in bands of EDGE_ARTIFACT_BAND_HEIGHT rows. Each band checks the hotspots whose closest texel it contains
+ * against the distance field, which is left unmodified until all bands have marked their artifacts in a bit mask, whose rows start at separate words.
+ */
 template <template <typename> class ContourCombiner, int N>
-static void msdfPatchEdgeArtifactsInner(const BitmapRef<float, N> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-    ShapeDistanceFinder<ContourCombiner<PseudoDistanceSelector> > distanceFinder(shape);
-    std::vector<Point2> hotspots;
-    findHotspots(hotspots, BitmapConstRef<float, N>(sdf));
-    std::vector<std::pair<int, int> > artifacts;
-    artifacts.reserve(hotspots.size());
-    for (std::vector<Point2>::const_iterator hotspot = hotspots.begin(); hotspot != hotspots.end(); ++hotspot) {
-        Point2 pos = *hotspot/scale-translate;
-        double actualDistance = distanceFinder.distance(pos);
-        float sd = float(actualDistance/range+.5);
-
-        // Store hotspot's closest texel's current color
-        float *subject = sdf((int) hotspot->x, (int) hotspot->y);
-        float texel[N];
-        memcpy(texel, subject, N*sizeof(float));
-        // Sample signed distance at hotspot
-        float msd[N];
-        interpolate(msd, BitmapConstRef<float, N>(sdf), *hotspot);
-        float oldSsd = median(msd[0], msd[1], msd[2]);
-        // Flatten hotspot's closest texel
-        float med = median(subject[0], subject[1], subject[2]);
-        subject[0] = med, subject[1] = med, subject[2] = med;
-        // Sample signed distance at hotspot after flattening
-        interpolate(msd, BitmapConstRef<float, N>(sdf), *hotspot);
-        float newSsd = median(msd[0], msd[1], msd[2]);
-        // Revert modified texel
-        memcpy(subject, texel, N*sizeof(float));
-
-        // Consider hotspot an artifact if flattening improved the sample
-        if (fabsf(newSsd-sd) < fabsf(oldSsd-sd))
-            artifacts.push_back(std::make_pair((int) hotspot->x, (int) hotspot->y));
+class EdgeArtifactPatcher {
+
+public:
+    typedef ShapeDistanceFinder<ContourCombiner<PseudoDistanceSelector>, CompiledShape> DistanceFinder;
+
+    /// If set, the marked artifacts are flattened, otherwise they are searched for.
+    bool flattenArtifacts;
+
+    EdgeArtifactPatcher(const BitmapRef<float, N> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const EdgeGrid *edgeGrid, int threadCount) :
+        flattenArtifacts(false), sdf(sdf), rowOffset(rowOffset), shape(shape), range(range), scale(scale), translate(translate), edgeGrid(edgeGrid),
+        maskStride((sdf.width+31)/32), mask(maskStride*sdf.height), distanceFinders(threadCount, (DistanceFinder *) NULL) { }
+
+    ~EdgeArtifactPatcher() {
+        for (typename std::vector<DistanceFinder *>::iterator distanceFinder = distanceFinders.begin(); distanceFinder != distanceFinders.end(); ++distanceFinder)
+            delete *distanceFinder;
     }
-    for (std::vector<std::pair<int, int> >::const_iterator artifact = artifacts.begin(); artifact != artifacts.end(); ++artifact) {
-        float *pixel = sdf(artifact->first, artifact->second);
-        float med = median(pixel[0], pixel[1], pixel[2]);
-        pixel[0] = med, pixel[1] = med, pixel[2] = med;
+
+    int bandCount() const {
+        return (sdf.height+EDGE_ARTIFACT_BAND_HEIGHT-1)/EDGE_ARTIFACT_BAND_HEIGHT;
     }
+
+    void operator()(int band, int thread) {
+        int y0 = band*EDGE_ARTIFACT_BAND_HEIGHT, y1 = min(y0+EDGE_ARTIFACT_BAND_HEIGHT, sdf.height);
+        if (flattenArtifacts) {
+            for (int y = y0; y < y1; ++y) {
+                unsigned *maskRow = &mask[maskStride*y];
+                for (int word = 0; word < maskStride; ++word) {
+                    for (int bit = 0; maskRow[word]; ++bit) {
+                        if (maskRow[word]&1u<<bit) {
+                            float *pixel = sdf(32*word+bit, y);
+                            float med = median(pixel[0], pixel[1], pixel[2]);
+                            pixel[0] = med, pixel[1] = med, pixel[2] = med;
+                            maskRow[word] &= ~(1u<<bit);
+                        }
+                    }
+                }
+            }
+        } else {
+            if (!distanceFinders[thread])
+                distanceFinders[thread] = new DistanceFinder(shape, edgeGrid);
+            HotspotChecker checker(*this, *distanceFinders[thread], y0, y1);
+            findHotspots(checker, BitmapConstRef<float, N>(sdf), rowOffset, y0, y1);
+        }
+    }
+
+private:
+    class HotspotChecker {
+
+    public:
+        HotspotChecker(EdgeArtifactPatcher &patcher, DistanceFinder &distanceFinder, int y0, int y1) : patcher(patcher), distanceFinder(distanceFinder), y0(y0), y1(y1) { }
+
+        void operator()(const Point2 &offsetHotspot) {
+            // The integer offset is subtracted exactly, so the sampling is not affected by it
+            Point2 hotspot(offsetHotspot.x, offsetHotspot.y-patcher.rowOffset);
+            int x = (int) hotspot.x, y = (int) hotspot.y;
+            if (y < y0 || y >= y1)
+                return;
+            BitmapConstRef<float, N> sdf(patcher.sdf);
+            Point2 pos = offsetHotspot/patcher.scale-patcher.translate;
+            double actualDistance = distanceFinder.distance(pos);
+            float sd = float(actualDistance/patcher.range+.5);
+
+            // Sample signed distance at hotspot
+            float msd[N];
+            interpolate(msd, sdf, hotspot);
+            float oldSsd = median(msd[0], msd[1], msd[2]);
+            // Sample signed distance at hotspot as if its closest texel was flattened
+            interpolateFlattened(msd, sdf, hotspot, x, y);
+            float newSsd = median(msd[0], msd[1], msd[2]);
+
+            // Consider hotspot an artifact if flattening improved the sample
+            if (fabsf(newSsd-sd) < fabsf(oldSsd-sd))
+                patcher.mask[patcher.maskStride*y+(x>>5)] |= 1u<<(x&31);
+        }
+
+    private:
+        EdgeArtifactPatcher &patcher;
+        DistanceFinder &distanceFinder;
+        int y0, y1;
+
+    };
+    friend class HotspotChecker;
+
+    BitmapRef<float, N> sdf;
+    int rowOffset;
+    const CompiledShape &shape;
+    double range;
+    Vector2 scale, translate;
+    const EdgeGrid *edgeGrid;
+    int maskStride;
+    std::vector<unsigned> mask;
+    std::vector<DistanceFinder *> distanceFinders;
+
+};
+
+template <template <typename> class ContourCombiner, int N>
+static void msdfPatchEdgeArtifactsInner(const BitmapRef<float, N> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    Executor &executor = resolveExecutor(config.executor);
+    EdgeArtifactPatcher<ContourCombiner, N> patcher(sdf, rowOffset, shape, range, scale, translate, config.edgeGrid, executor.threadCount());
+    parallelFor(&executor, patcher.bandCount(), patcher);
+    patcher.flattenArtifacts = true;
+    parallelFor(&executor, patcher.bandCount(), patcher);
 }
 
-void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
-    if (overlapSupport)
-        msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate);
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    CompiledShape compiledShape(shape, config.cubicTolerance);
+    msdfPatchEdgeArtifacts(sdf, 0, compiledShape, range, scale, translate, config);
+}
+
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    CompiledShape compiledShape(shape, config.cubicTolerance);
+    msdfPatchEdgeArtifacts(sdf, 0, compiledShape, range, scale, translate, config);
+}
+
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, rowOffset, shape, range, scale, translate, config);
     else
-        msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate);
+        msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, rowOffset, shape, range, scale, translate, config);
 }
 
-void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
-    if (overlapSupport)
-        msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate);
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, rowOffset, shape, range, scale, translate, config);
     else
-        msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate);
+        msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, rowOffset, shape, range, scale, translate, config);
+}
+
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
+    msdfPatchEdgeArtifacts(sdf, shape, range, scale, translate, GeneratorConfig(overlapSupport));
+}
+
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
+    msdfPatchEdgeArtifacts(sdf, shape, range, scale, translate, GeneratorConfig(overlapSupport));
 }
 
 }
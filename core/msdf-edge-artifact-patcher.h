@@ -4,10 +4,17 @@
 #include "Vector2.h"
 #include "Shape.h"
 #include "BitmapRef.hpp"
+#include "CompiledShape.h"
+#include "generator-config.h"
 
 namespace msdfgen {
 
 void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true);
 void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true);
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+/// Patches a horizontal band of rows of a larger distance field, whose first row is row rowOffset of the whole. Rows near the edges of the band which are not edges of the whole may be patched differently than in the whole.
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, int rowOffset, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
 
 }
@@ -4,74 +4,112 @@
 #include <vector>
 #include "arithmetics.hpp"
 
+// The number of rows processed by each task of the error correction passes
+#define ERROR_CORRECTION_BAND_HEIGHT 16
+
 namespace msdfgen {
 
 inline static bool detectClash(const float *a, const float *b, double threshold) {
-    // Sort channels so that pairs (a0, b0), (a1, b1), (a2, b2) go from biggest to smallest absolute difference
-    float a0 = a[0], a1 = a[1], a2 = a[2];
-    float b0 = b[0], b1 = b[1], b2 = b[2];
-    float tmp;
-    if (fabsf(b0-a0) < fabsf(b1-a1)) {
-        tmp = a0, a0 = a1, a1 = tmp;
-        tmp = b0, b0 = b1, b1 = tmp;
-    }
-    if (fabsf(b1-a1) < fabsf(b2-a2)) {
-        tmp = a1, a1 = a2, a2 = tmp;
-        tmp = b1, b1 = b2, b2 = tmp;
-        if (fabsf(b0-a0) < fabsf(b1-a1)) {
-            tmp = a0, a0 = a1, a1 = tmp;
-            tmp = b0, b0 = b1, b1 = tmp;
-        }
-    }
-    return (fabsf(b1-a1) >= threshold) &&
-        !(b0 == b1 && b0 == b2) && // Ignore if other pixel has been equalized
-        fabsf(a2-.5f) >= fabsf(b2-.5f); // Out of the pair, only flag the pixel farther from a shape edge
+    // The channel pairs (a[i], b[i]) are ranked from biggest to smallest absolute difference, with ties keeping the channel order, which is resolved without branches:
+    // the middle difference is the median, and the pair with the smallest difference is the smaller of the first two unless the third one is smaller or equal
+    float d0 = fabsf(b[0]-a[0]), d1 = fabsf(b[1]-a[1]), d2 = fabsf(b[2]-a[2]);
+    int low = d0 < d1 ? 0 : 1;
+    low = min(d0, d1) < d2 ? low : 2;
+    return (median(d0, d1, d2) >= threshold) &&
+        !(b[0] == b[1] && b[0] == b[2]) && // Ignore if other pixel has been equalized
+        fabsf(a[low]-.5f) >= fabsf(b[low]-.5f); // Out of the pair, only flag the pixel farther from a shape edge
 }
 
+/// Performs the error correction passes on bands of ERROR_CORRECTION_BAND_HEIGHT rows. Clashing pixels are first marked in a bit mask, whose rows start at separate words, and equalized afterwards.
 template <int N>
-void msdfErrorCorrectionInner(const BitmapRef<float, N> &output, const Vector2 &threshold) {
-    std::vector<std::pair<int, int> > clashes;
-    int w = output.width, h = output.height;
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x) {
-            if (
-                (x > 0 && detectClash(output(x, y), output(x-1, y), threshold.x)) ||
-                (x < w-1 && detectClash(output(x, y), output(x+1, y), threshold.x)) ||
-                (y > 0 && detectClash(output(x, y), output(x, y-1), threshold.y)) ||
-                (y < h-1 && detectClash(output(x, y), output(x, y+1), threshold.y))
-            )
-                clashes.push_back(std::make_pair(x, y));
-        }
-    for (std::vector<std::pair<int, int> >::const_iterator clash = clashes.begin(); clash != clashes.end(); ++clash) {
-        float *pixel = output(clash->first, clash->second);
-        float med = median(pixel[0], pixel[1], pixel[2]);
-        pixel[0] = med, pixel[1] = med, pixel[2] = med;
+class ErrorCorrection {
+
+public:
+    enum Stage {
+        DETECT_ORTHOGONAL_CLASHES,
+        DETECT_DIAGONAL_CLASHES,
+        EQUALIZE_CLASHES
+    };
+
+    Stage stage;
+
+    ErrorCorrection(const BitmapRef<float, N> &output, const Vector2 &threshold) : stage(DETECT_ORTHOGONAL_CLASHES), output(output), threshold(threshold), maskStride((output.width+31)/32), mask(maskStride*output.height) { }
+
+    int bandCount() const {
+        return (output.height+ERROR_CORRECTION_BAND_HEIGHT-1)/ERROR_CORRECTION_BAND_HEIGHT;
     }
-#ifndef MSDFGEN_NO_DIAGONAL_CLASH_DETECTION
-    clashes.clear();
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x) {
-            if (
-                (x > 0 && y > 0 && detectClash(output(x, y), output(x-1, y-1), threshold.x+threshold.y)) ||
-                (x < w-1 && y > 0 && detectClash(output(x, y), output(x+1, y-1), threshold.x+threshold.y)) ||
-                (x > 0 && y < h-1 && detectClash(output(x, y), output(x-1, y+1), threshold.x+threshold.y)) ||
-                (x < w-1 && y < h-1 && detectClash(output(x, y), output(x+1, y+1), threshold.x+threshold.y))
-            )
-                clashes.push_back(std::make_pair(x, y));
+
+    void operator()(int band, int) {
+        int w = output.width, h = output.height;
+        for (int y = band*ERROR_CORRECTION_BAND_HEIGHT, y1 = min(y+ERROR_CORRECTION_BAND_HEIGHT, h); y < y1; ++y) {
+            unsigned *maskRow = &mask[maskStride*y];
+            switch (stage) {
+                case DETECT_ORTHOGONAL_CLASHES:
+                    for (int x = 0; x < w; ++x) {
+                        if (
+                            (x > 0 && detectClash(output(x, y), output(x-1, y), threshold.x)) ||
+                            (x < w-1 && detectClash(output(x, y), output(x+1, y), threshold.x)) ||
+                            (y > 0 && detectClash(output(x, y), output(x, y-1), threshold.y)) ||
+                            (y < h-1 && detectClash(output(x, y), output(x, y+1), threshold.y))
+                        )
+                            maskRow[x>>5] |= 1u<<(x&31);
+                    }
+                    break;
+                case DETECT_DIAGONAL_CLASHES:
+                    for (int x = 0; x < w; ++x) {
+                        if (
+                            (x > 0 && y > 0 && detectClash(output(x, y), output(x-1, y-1), threshold.x+threshold.y)) ||
+                            (x < w-1 && y > 0 && detectClash(output(x, y), output(x+1, y-1), threshold.x+threshold.y)) ||
+                            (x > 0 && y < h-1 && detectClash(output(x, y), output(x-1, y+1), threshold.x+threshold.y)) ||
+                            (x < w-1 && y < h-1 && detectClash(output(x, y), output(x+1, y+1), threshold.x+threshold.y))
+                        )
+                            maskRow[x>>5] |= 1u<<(x&31);
+                    }
+                    break;
+                case EQUALIZE_CLASHES:
+                    for (int word = 0; word < maskStride; ++word) {
+                        for (int bit = 0; maskRow[word]; ++bit) {
+                            if (maskRow[word]&1u<<bit) {
+                                float *pixel = output(32*word+bit, y);
+                                float med = median(pixel[0], pixel[1], pixel[2]);
+                                pixel[0] = med, pixel[1] = med, pixel[2] = med;
+                                maskRow[word] &= ~(1u<<bit);
+                            }
+                        }
+                    }
+                    break;
+            }
         }
-    for (std::vector<std::pair<int, int> >::const_iterator clash = clashes.begin(); clash != clashes.end(); ++clash) {
-        float *pixel = output(clash->first, clash->second);
-        float med = median(pixel[0], pixel[1], pixel[2]);
-        pixel[0] = med, pixel[1] = med, pixel[2] = med;
     }
+
+private:
+    BitmapRef<float, N> output;
+    Vector2 threshold;
+    int maskStride;
+    std::vector<unsigned> mask;
+
+};
+
+template <int N>
+void msdfErrorCorrectionInner(const BitmapRef<float, N> &output, const Vector2 &threshold, Executor *executor) {
+    // All clashes of a pass are detected before any pixel is equalized, which leaves the mask cleared for the next pass
+    ErrorCorrection<N> errorCorrection(output, threshold);
+    parallelFor(executor, errorCorrection.bandCount(), errorCorrection);
+    errorCorrection.stage = ErrorCorrection<N>::EQUALIZE_CLASHES;
+    parallelFor(executor, errorCorrection.bandCount(), errorCorrection);
+#ifndef MSDFGEN_NO_DIAGONAL_CLASH_DETECTION
+    errorCorrection.stage = ErrorCorrection<N>::DETECT_DIAGONAL_CLASHES;
+    parallelFor(executor, errorCorrection.bandCount(), errorCorrection);
+    errorCorrection.stage = ErrorCorrection<N>::EQUALIZE_CLASHES;
+    parallelFor(executor, errorCorrection.bandCount(), errorCorrection);
 #endif
 }
 
-void msdfErrorCorrection(const BitmapRef<float, 3> &output, const Vector2 &threshold) {
-    msdfErrorCorrectionInner(output, threshold);
+void msdfErrorCorrection(const BitmapRef<float, 3> &output, const Vector2 &threshold, Executor *executor) {
+    msdfErrorCorrectionInner(output, threshold, executor);
 }
-void msdfErrorCorrection(const BitmapRef<float, 4> &output, const Vector2 &threshold) {
-    msdfErrorCorrectionInner(output, threshold);
+void msdfErrorCorrection(const BitmapRef<float, 4> &output, const Vector2 &threshold, Executor *executor) {
+    msdfErrorCorrectionInner(output, threshold, executor);
 }
 
 }
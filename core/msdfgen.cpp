@@ -2,11 +2,23 @@
 #include "../msdfgen.h"
 
 #include <vector>
+#include <algorithm>
 #include "edge-selectors.h"
 #include "contour-combiners.h"
 #include "ShapeDistanceFinder.h"
+#include "BatchShapeDistanceFinder.h"
 #include "msdf-edge-artifact-patcher.h"
 
+// The sizes of the largest and smallest square pixel cells which are tested for saturation or interpolation at once in narrow band mode (powers of two)
+#define NARROW_BAND_ROOT_SIZE 64
+#define NARROW_BAND_LEAF_SIZE 4
+// The width in pixels and height in strips of MSDFGEN_BATCH_SIZE rows of the tiles in tile traversal mode
+#define TRAVERSAL_TILE_SIZE 16
+// The height of the bands in which distance fields are generated when they are not held in memory as a whole in floating-point (a multiple of NARROW_BAND_ROOT_SIZE)
+#define GENERATOR_BAND_HEIGHT 64
+// The number of rows beyond a pixel that may affect its error correction and edge artifact patching
+#define GENERATOR_BAND_HALO 3
+
 namespace msdfgen {
 
 template <typename DistanceType>
@@ -15,93 +27,805 @@ class DistancePixelConversion;
 template <>
 class DistancePixelConversion<double> {
 public:
-    typedef BitmapRef<float, 1> BitmapRefType;
-    inline static void convert(float *pixels, double distance, double range) {
-        *pixels = float(distance/range+.5);
+    static const int CHANNELS = 1;
+    template <typename T>
+    inline static void convert(T *pixels, double distance, double range) {
+        storePixelValue(pixels[0], float(distance/range+.5));
     }
 };
 
 template <>
 class DistancePixelConversion<MultiDistance> {
 public:
-    typedef BitmapRef<float, 3> BitmapRefType;
-    inline static void convert(float *pixels, const MultiDistance &distance, double range) {
-        pixels[0] = float(distance.r/range+.5);
-        pixels[1] = float(distance.g/range+.5);
-        pixels[2] = float(distance.b/range+.5);
+    static const int CHANNELS = 3;
+    template <typename T>
+    inline static void convert(T *pixels, const MultiDistance &distance, double range) {
+        storePixelValue(pixels[0], float(distance.r/range+.5));
+        storePixelValue(pixels[1], float(distance.g/range+.5));
+        storePixelValue(pixels[2], float(distance.b/range+.5));
     }
 };
 
 template <>
 class DistancePixelConversion<MultiAndTrueDistance> {
 public:
-    typedef BitmapRef<float, 4> BitmapRefType;
-    inline static void convert(float *pixels, const MultiAndTrueDistance &distance, double range) {
-        pixels[0] = float(distance.r/range+.5);
-        pixels[1] = float(distance.g/range+.5);
-        pixels[2] = float(distance.b/range+.5);
-        pixels[3] = float(distance.a/range+.5);
+    static const int CHANNELS = 4;
+    template <typename T>
+    inline static void convert(T *pixels, const MultiAndTrueDistance &distance, double range) {
+        storePixelValue(pixels[0], float(distance.r/range+.5));
+        storePixelValue(pixels[1], float(distance.g/range+.5));
+        storePixelValue(pixels[2], float(distance.b/range+.5));
+        storePixelValue(pixels[3], float(distance.a/range+.5));
     }
 };
 
-template <class ContourCombiner>
-void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel
-#endif
-    {
-        ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
-        bool rightToLeft = false;
-        Point2 p;
-#ifdef MSDFGEN_USE_OPENMP
-        #pragma omp for
-#endif
-        for (int y = 0; y < output.height; ++y) {
-            int row = shape.inverseYAxis ? output.height-y-1 : y;
-            p.y = (y+.5)/scale.y-translate.y;
-            for (int col = 0; col < output.width; ++col) {
-                int x = rightToLeft ? output.width-col-1 : col;
-                p.x = (x+.5)/scale.x-translate.x;
-                typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
-                DistancePixelConversion<typename ContourCombiner::DistanceType>::convert(output(x, row), distance, range);
+/// The rows of a distance field being generated, which may be a horizontal band of rows starting at rowOffset of a larger bitmap.
+template <typename T, int N>
+struct DistanceFieldWindow {
+    BitmapRef<T, N> output;
+    int imageHeight, rowOffset;
+    bool inverseYAxis;
+
+    DistanceFieldWindow(const BitmapRef<T, N> &output, int imageHeight, int rowOffset, bool inverseYAxis) : output(output), imageHeight(imageHeight), rowOffset(rowOffset), inverseYAxis(inverseYAxis) { }
+
+    /// The range of rows of the shape's coordinate system covered by the window.
+    int firstRow() const {
+        return inverseYAxis ? imageHeight-rowOffset-output.height : rowOffset;
+    }
+    int endRow() const {
+        return firstRow()+output.height;
+    }
+
+    /// Returns the pixel of the window in row y of the shape's coordinate system.
+    T *operator()(int x, int y) const {
+        return output(x, (inverseYAxis ? imageHeight-y-1 : y)-rowOffset);
+    }
+};
+
+static void setDistance(double &distance, double value) {
+    distance = value;
+}
+
+static void setDistance(MultiDistance &distance, double value) {
+    distance.r = value, distance.g = value, distance.b = value;
+}
+
+static void setDistance(MultiAndTrueDistance &distance, double value) {
+    distance.r = value, distance.g = value, distance.b = value, distance.a = value;
+}
+
+static double resolveDistance(double distance) {
+    return distance;
+}
+
+static double resolveDistance(const MultiDistance &distance) {
+    return median(distance.r, distance.g, distance.b);
+}
+
+static double distanceDeviation(double a, double b) {
+    return fabs(a-b);
+}
+
+static double distanceDeviation(const MultiDistance &a, const MultiDistance &b) {
+    return max(max(fabs(a.r-b.r), fabs(a.g-b.g)), fabs(a.b-b.b));
+}
+
+static double distanceDeviation(const MultiAndTrueDistance &a, const MultiAndTrueDistance &b) {
+    return max(distanceDeviation(static_cast<const MultiDistance &>(a), static_cast<const MultiDistance &>(b)), fabs(a.a-b.a));
+}
+
+static double mixDistance(double a, double b, double weight) {
+    return mix(a, b, weight);
+}
+
+static MultiDistance mixDistance(const MultiDistance &a, const MultiDistance &b, double weight) {
+    MultiDistance distance;
+    distance.r = mix(a.r, b.r, weight), distance.g = mix(a.g, b.g, weight), distance.b = mix(a.b, b.b, weight);
+    return distance;
+}
+
+static MultiAndTrueDistance mixDistance(const MultiAndTrueDistance &a, const MultiAndTrueDistance &b, double weight) {
+    MultiAndTrueDistance distance;
+    distance.r = mix(a.r, b.r, weight), distance.g = mix(a.g, b.g, weight), distance.b = mix(a.b, b.b, weight), distance.a = mix(a.a, b.a, weight);
+    return distance;
+}
+
+/// Bilinearly interpolates the distances at the corners of a cell, indexed by [x][y].
+template <typename DistanceType>
+static DistanceType interpolateDistance(const DistanceType corners[2][2], double u, double v) {
+    return mixDistance(mixDistance(corners[0][0], corners[1][0], u), mixDistance(corners[0][1], corners[1][1], u), v);
+}
+
+/// Generates the distance field like generateDistanceField but saturates pixels which are provably outside of the range, and optionally interpolates smooth regions.
+/// Each task processes a square cell of NARROW_BAND_ROOT_SIZE pixels, which is recursively subdivided until its sub-cells can be saturated, interpolated, or are small enough to be computed per pixel.
+/// Cells are clipped to the rows of the window, so the result of a window only equals the respective rows of the whole distance field if its bounds are aligned to NARROW_BAND_ROOT_SIZE rows.
+template <class ContourCombiner, typename T>
+class NarrowBandGenerator {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+    typedef DistanceFieldWindow<T, DistancePixelConversion<DistanceType>::CHANNELS> Window;
+
+    NarrowBandGenerator(const Window &window, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const EdgeGrid *edgeGrid, double interpolationTolerance, int threadCount) :
+        window(window), shape(shape), range(range), scale(scale), translate(translate), edgeGrid(edgeGrid), interpolationTolerance(interpolationTolerance),
+        firstRow(window.firstRow()), endRow(window.endRow()), rootColumns((window.output.width+NARROW_BAND_ROOT_SIZE-1)/NARROW_BAND_ROOT_SIZE),
+        firstRootRow(firstRow/NARROW_BAND_ROOT_SIZE), rootRows(endRow > firstRow ? (endRow-1)/NARROW_BAND_ROOT_SIZE-firstRootRow+1 : 0),
+        threads(threadCount, (ThreadState *) NULL) { }
+
+    ~NarrowBandGenerator() {
+        for (typename std::vector<ThreadState *>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+            delete *thread;
+    }
+
+    int taskCount() const {
+        return rootColumns*rootRows;
+    }
+
+    void operator()(int index, int thread) {
+        if (!threads[thread])
+            threads[thread] = new ThreadState(shape, edgeGrid);
+        generateCell(*threads[thread], index%rootColumns*NARROW_BAND_ROOT_SIZE, (firstRootRow+index/rootColumns)*NARROW_BAND_ROOT_SIZE, NARROW_BAND_ROOT_SIZE);
+    }
+
+private:
+    /// The distance finders of one thread.
+    struct ThreadState {
+        ShapeDistanceFinder<ContourCombiner, CompiledShape> distanceFinder;
+        // The distance to the nearest edge is 1-Lipschitz, so its value at a cell's center bounds it within the whole cell
+        ShapeDistanceFinder<SimpleContourCombiner<TrueDistanceSelector>, CompiledShape> boundDistanceFinder;
+
+        ThreadState(const CompiledShape &shape, const EdgeGrid *edgeGrid) : distanceFinder(shape, edgeGrid), boundDistanceFinder(shape, edgeGrid) { }
+    };
+
+    Window window;
+    const CompiledShape &shape;
+    double range;
+    Vector2 scale, translate;
+    const EdgeGrid *edgeGrid;
+    double interpolationTolerance;
+    int firstRow, endRow;
+    int rootColumns, firstRootRow, rootRows;
+    std::vector<ThreadState *> threads;
+
+    Point2 pixelPosition(double x, double y) const {
+        return Point2((x+.5)/scale.x-translate.x, (y+.5)/scale.y-translate.y);
+    }
+
+    void setPixel(int x, int y, const DistanceType &distance) {
+        DistancePixelConversion<DistanceType>::convert(window(x, y), distance, range);
+    }
+
+    void generateCell(ThreadState &state, int x0, int cellY0, int size) {
+        int x1 = min(x0+size, window.output.width);
+        int y0 = max(cellY0, firstRow), y1 = min(cellY0+size, endRow);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+        double radius = Vector2(.5*(x1-x0-1)/scale.x, .5*(y1-y0-1)/scale.y).length();
+        double bound = fabs(state.boundDistanceFinder.distance(pixelPosition(.5*(x0+x1-1), .5*(y0+y1-1))))-radius;
+        // No edge passes through a saturated cell, so the sign of the distance is the same everywhere within it
+        if (bound > .5*fabs(range)) {
+            DistanceType distance;
+            setDistance(distance, resolveDistance(state.distanceFinder.distance(pixelPosition(.5*(x0+x1-1), .5*(y0+y1-1)))) > 0 ? .5*range : -.5*range);
+            for (int y = y0; y < y1; ++y)
+                for (int x = x0; x < x1; ++x)
+                    setPixel(x, y, distance);
+            return;
+        }
+        if (size <= NARROW_BAND_LEAF_SIZE) {
+            for (int y = y0; y < y1; ++y) {
+                for (int col = 0; col < x1-x0; ++col) {
+                    int x = (y-y0)&1 ? x1-col-1 : x0+col;
+                    setPixel(x, y, state.distanceFinder.distance(pixelPosition(x, y)));
+                }
+            }
+            return;
+        }
+        // Cells without edges that lie entirely within the range, so that none of their pixels would be saturated,
+        // are interpolated from their corners if the distances at the center and the midpoints of the sides match the interpolation
+        if (interpolationTolerance > 0 && bound > 0 && bound+2*radius <= .5*fabs(range) && x1-x0 > 1 && y1-y0 > 1 && interpolateCell(state, x0, y0, x1, y1))
+            return;
+        int half = size/2;
+        generateCell(state, x0, cellY0, half);
+        generateCell(state, x0+half, cellY0, half);
+        generateCell(state, x0+half, cellY0+half, half);
+        generateCell(state, x0, cellY0+half, half);
+    }
+
+    bool interpolateCell(ThreadState &state, int x0, int y0, int x1, int y1) {
+        DistanceType corners[2][2];
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < 2; ++j)
+                corners[i][j] = state.distanceFinder.distance(pixelPosition(i ? x1-1 : x0, j ? y1-1 : y0));
+        static const double testPoints[5][2] = { { .5, .5 }, { .5, 0 }, { 1, .5 }, { .5, 1 }, { 0, .5 } };
+        for (int i = 0; i < 5; ++i) {
+            double u = testPoints[i][0], v = testPoints[i][1];
+            DistanceType distance = state.distanceFinder.distance(pixelPosition(mix(double(x0), double(x1-1), u), mix(double(y0), double(y1-1), v)));
+            if (distanceDeviation(distance, interpolateDistance(corners, u, v)) > interpolationTolerance)
+                return false;
+        }
+        for (int y = y0; y < y1; ++y)
+            for (int x = x0; x < x1; ++x)
+                setPixel(x, y, interpolateDistance(corners, double(x-x0)/(x1-1-x0), double(y-y0)/(y1-1-y0)));
+        return true;
+    }
+
+};
+
+template <class ContourCombiner, typename T>
+void generateNarrowBandDistanceField(const DistanceFieldWindow<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS> &window, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    Executor &executor = resolveExecutor(config.executor);
+    NarrowBandGenerator<ContourCombiner, T> generator(window, shape, range, scale, translate, config.edgeGrid, config.interpolationTolerance, executor.threadCount());
+    parallelFor(&executor, generator.taskCount(), generator);
+}
+
+/// Converts a position along a Hilbert curve filling a square of size (a power of two) to the coordinates of the respective cell.
+static void hilbertCurveCell(int &x, int &y, int size, int position) {
+    x = 0, y = 0;
+    for (int s = 1; s < size; s *= 2) {
+        int rx = 1&position>>1;
+        int ry = 1&(position^rx);
+        if (!ry) {
+            if (rx)
+                x = s-1-x, y = s-1-y;
+            int t = x;
+            x = y, y = t;
+        }
+        x += s*rx, y += s*ry;
+        position >>= 2;
+    }
+}
+
+/// Generates the distance field in strips of MSDFGEN_BATCH_SIZE rows, whose vertically adjacent pixels are evaluated as one batch. Each task covers a strip in row traversal mode or a tile in tile traversal mode.
+/// The strips are aligned to the rows of the whole distance field, so the pixels of a window are equal to the respective pixels of the whole.
+template <class ContourCombiner, class Batch, typename T>
+class BatchedGenerator {
+
+public:
+    typedef DistanceFieldWindow<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS> Window;
+
+    BatchedGenerator(const Window &window, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const EdgeGrid *edgeGrid, PixelTraversal traversal, int threadCount) :
+        window(window), shape(shape), range(range), scale(scale), translate(translate), edgeGrid(edgeGrid), firstRow(window.firstRow()), endRow(window.endRow()),
+        firstStrip(firstRow/MSDFGEN_BATCH_SIZE), strips(endRow > firstRow ? (endRow-1)/MSDFGEN_BATCH_SIZE-firstStrip+1 : 0), tileColumns(0),
+        distanceFinders(threadCount, (BatchShapeDistanceFinder<ContourCombiner, Batch> *) NULL) {
+        if (traversal == TILE_TRAVERSAL) {
+            // Tiles are listed in the order of a Hilbert curve covering them
+            tileColumns = (window.output.width+TRAVERSAL_TILE_SIZE-1)/TRAVERSAL_TILE_SIZE;
+            int tileRows = (strips+TRAVERSAL_TILE_SIZE-1)/TRAVERSAL_TILE_SIZE;
+            int curveSize = 1;
+            while (curveSize < tileColumns || curveSize < tileRows)
+                curveSize *= 2;
+            tiles.reserve(tileColumns*tileRows);
+            for (int i = 0; i < curveSize*curveSize; ++i) {
+                int tileX, tileY;
+                hilbertCurveCell(tileX, tileY, curveSize, i);
+                if (tileX < tileColumns && tileY < tileRows)
+                    tiles.push_back(tileY*tileColumns+tileX);
             }
-            rightToLeft = !rightToLeft;
         }
     }
+
+    ~BatchedGenerator() {
+        for (typename std::vector<BatchShapeDistanceFinder<ContourCombiner, Batch> *>::iterator distanceFinder = distanceFinders.begin(); distanceFinder != distanceFinders.end(); ++distanceFinder)
+            delete *distanceFinder;
+    }
+
+    int taskCount() const {
+        return tileColumns ? (int) tiles.size() : strips;
+    }
+
+    void operator()(int index, int thread) {
+        if (!distanceFinders[thread])
+            distanceFinders[thread] = new BatchShapeDistanceFinder<ContourCombiner, Batch>(shape, edgeGrid);
+        BatchShapeDistanceFinder<ContourCombiner, Batch> &distanceFinder = *distanceFinders[thread];
+        if (tileColumns) {
+            int x0 = tiles[index]%tileColumns*TRAVERSAL_TILE_SIZE, strip0 = tiles[index]/tileColumns*TRAVERSAL_TILE_SIZE;
+            int x1 = min(x0+TRAVERSAL_TILE_SIZE, window.output.width), strip1 = min(strip0+TRAVERSAL_TILE_SIZE, strips);
+            // The batches are taller than wide, so the tile's strips are traversed in alternating direction rather than along a Hilbert curve
+            for (int strip = strip0; strip < strip1; ++strip) {
+                for (int col = 0; col < x1-x0; ++col) {
+                    int x = (strip-strip0)&1 ? x1-col-1 : x0+col;
+                    generateBatch(distanceFinder, x, (firstStrip+strip)*MSDFGEN_BATCH_SIZE);
+                }
+            }
+        } else {
+            for (int col = 0; col < window.output.width; ++col) {
+                int x = (firstStrip+index)&1 ? window.output.width-col-1 : col;
+                generateBatch(distanceFinder, x, (firstStrip+index)*MSDFGEN_BATCH_SIZE);
+            }
+        }
+    }
+
+private:
+    Window window;
+    const CompiledShape &shape;
+    double range;
+    Vector2 scale, translate;
+    const EdgeGrid *edgeGrid;
+    int firstRow, endRow;
+    int firstStrip, strips, tileColumns;
+    std::vector<int> tiles;
+    std::vector<BatchShapeDistanceFinder<ContourCombiner, Batch> *> distanceFinders;
+
+    /// Computes the distances of the batch of MSDFGEN_BATCH_SIZE vertically adjacent pixels in column x starting at row y0 and stores those within the window.
+    void generateBatch(BatchShapeDistanceFinder<ContourCombiner, Batch> &distanceFinder, int x, int y0) {
+        Point2 p[MSDFGEN_BATCH_SIZE];
+        typename ContourCombiner::DistanceType distances[MSDFGEN_BATCH_SIZE];
+        // Lanes past the last row repeat it and their results are discarded
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+            p[i] = Point2((x+.5)/scale.x-translate.x, (min(y0+i, window.imageHeight-1)+.5)/scale.y-translate.y);
+        distanceFinder.distance(distances, p);
+        for (int y = max(y0, firstRow), y1 = min(y0+MSDFGEN_BATCH_SIZE, endRow); y < y1; ++y)
+            DistancePixelConversion<typename ContourCombiner::DistanceType>::convert(window(x, y), distances[y-y0], range);
+    }
+
+};
+
+template <class ContourCombiner, class Batch, typename T>
+void generateBatchedDistanceField(const DistanceFieldWindow<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS> &window, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    Executor &executor = resolveExecutor(config.executor);
+    BatchedGenerator<ContourCombiner, Batch, T> generator(window, shape, range, scale, translate, config.edgeGrid, config.traversal, executor.threadCount());
+    parallelFor(&executor, generator.taskCount(), generator);
 }
 
-void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
-    if (overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate);
+template <class ContourCombiner, typename T>
+void generateDistanceField(const DistanceFieldWindow<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS> &window, const CompiledShape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.narrowBand)
+        generateNarrowBandDistanceField<ContourCombiner, T>(window, shape, range, scale, translate, config);
+    else if (config.singlePrecision)
+        generateBatchedDistanceField<ContourCombiner, FloatBatch, T>(window, shape, range, scale, translate, config);
     else
-        generateDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate);
+        generateBatchedDistanceField<ContourCombiner, DoubleBatch, T>(window, shape, range, scale, translate, config);
 }
 
-void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
-    if (overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate);
+/// Generates the whole distance field of the shape into output.
+template <class ContourCombiner, typename T>
+void generateDistanceField(const BitmapRef<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    CompiledShape compiledShape(shape, config.cubicTolerance);
+    generateDistanceField<ContourCombiner, T>(DistanceFieldWindow<T, DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS>(output, output.height, 0, shape.inverseYAxis), compiledShape, range, scale, translate, config);
+}
+
+static bool hasPostProcessing(const GeneratorConfig &config) {
+    return config.scanlinePass;
+}
+
+static bool hasPostProcessing(const MSDFGeneratorConfig &) {
+    return true;
+}
+
+/// Returns the number of rows beyond a pixel that may affect its post-processing, whose passes each depend on the results of the previous one in the neighborhood.
+static int bandHalo(const GeneratorConfig &) {
+    return 0;
+}
+
+static int bandHalo(const MSDFGeneratorConfig &config) {
+    return config.scanlinePass ? 2*GENERATOR_BAND_HALO+1 : GENERATOR_BAND_HALO;
+}
+
+/// Performs the passes which follow the generation of a distance field, on a band of rows of the whole.
+template <int N>
+static void postProcessBand(const BitmapRef<float, N> &band, int rowOffset, int imageHeight, const Shape &shape, const CompiledShape &, double, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.scanlinePass)
+        distanceSignCorrection(band, rowOffset, imageHeight, shape, scale, translate, config.fillRule, config.executor);
+}
+
+template <int N>
+static void postProcessBand(const BitmapRef<float, N> &band, int rowOffset, int imageHeight, const Shape &shape, const CompiledShape &compiledShape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.edgeThreshold > 0)
+        msdfErrorCorrection(band, config.edgeThreshold/(scale*range), config.executor);
+    msdfPatchEdgeArtifacts(band, rowOffset, compiledShape, range, scale, translate, config);
+    if (config.scanlinePass) {
+        distanceSignCorrection(band, rowOffset, imageHeight, shape, scale, translate, config.fillRule, config.executor);
+        if (config.edgeThreshold > 0)
+            msdfErrorCorrection(band, config.edgeThreshold/(scale*range), config.executor);
+    }
+}
+
+/// Generates a distance field of width x height pixels in bands of GENERATOR_BAND_HEIGHT rows, aligned to the cells of narrow band mode, and passes each finished row to rowHandler(y, pixels),
+/// in the order of decreasing y if topDown is set or increasing otherwise, until it returns false. The bands are generated into a float buffer, which keeps the rows of the previous band within the halo,
+/// so that the post-processing of each row sees the same neighborhood as in the whole distance field.
+template <class ContourCombiner, class RowHandler, class Config>
+static bool generateDistanceFieldBands(RowHandler &rowHandler, int w, int h, bool topDown, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const Config &config) {
+    const int N = DistancePixelConversion<typename ContourCombiner::DistanceType>::CHANNELS;
+    if (!(w > 0 && h > 0))
+        return true;
+    CompiledShape compiledShape(shape, config.cubicTolerance);
+    int halo = bandHalo(config);
+    // The bands are aligned in the shape's coordinate system, whose rows are in reverse order if the Y axis is inverted
+    int alignment = shape.inverseYAxis ? h%GENERATOR_BAND_HEIGHT : 0;
+    // The generated rows from bufferStart to bufferEnd, and the rows which have been passed to rowHandler, which are those below committed, or above if topDown
+    std::vector<float> buffer, correctedBuffer;
+    int bufferStart = topDown ? h : 0, bufferEnd = bufferStart;
+    int committed = bufferStart;
+    while (topDown ? committed > 0 : committed < h) {
+        int bandStart, bandEnd;
+        if (topDown) {
+            bandEnd = bufferStart;
+            bandStart = bandEnd <= alignment ? 0 : alignment+(bandEnd-alignment-1)/GENERATOR_BAND_HEIGHT*GENERATOR_BAND_HEIGHT;
+            int keepEnd = min(committed+halo, h);
+            buffer.resize(N*w*(keepEnd-bufferStart));
+            buffer.insert(buffer.begin(), N*w*(bandEnd-bandStart), 0.f);
+            bufferStart = bandStart, bufferEnd = keepEnd;
+        } else {
+            bandStart = bufferEnd;
+            bandEnd = bandStart < alignment ? alignment : min(alignment+((bandStart-alignment)/GENERATOR_BAND_HEIGHT+1)*GENERATOR_BAND_HEIGHT, h);
+            int keepStart = max(committed-halo, 0);
+            buffer.erase(buffer.begin(), buffer.begin()+N*w*(keepStart-bufferStart));
+            buffer.resize(N*w*(bandEnd-keepStart));
+            bufferStart = keepStart, bufferEnd = bandEnd;
+        }
+        BitmapRef<float, N> band(&buffer[N*w*(bandStart-bufferStart)], w, bandEnd-bandStart);
+        generateDistanceField<ContourCombiner, float>(DistanceFieldWindow<float, N>(band, h, bandStart, shape.inverseYAxis), compiledShape, range, scale, translate, config);
+        // Rows within the halo of the unfinished side of the buffer are post-processed again with the next band
+        const float *rows = &buffer[0];
+        if (hasPostProcessing(config)) {
+            correctedBuffer = buffer;
+            postProcessBand(BitmapRef<float, N>(&correctedBuffer[0], w, bufferEnd-bufferStart), bufferStart, h, shape, compiledShape, range, scale, translate, config);
+            rows = &correctedBuffer[0];
+        }
+        if (topDown) {
+            int commitEnd = bandStart == 0 ? 0 : min(bandStart+halo, committed);
+            for (; committed > commitEnd; --committed)
+                if (!rowHandler(committed-1, rows+N*w*(committed-1-bufferStart)))
+                    return false;
+        } else {
+            int commitEnd = bandEnd == h ? h : max(bandEnd-halo, committed);
+            for (; committed < commitEnd; ++committed)
+                if (!rowHandler(committed, rows+N*w*(committed-bufferStart)))
+                    return false;
+        }
+    }
+    return true;
+}
+
+/// Stores the rows of a distance field in a bitmap of integer pixels.
+template <typename T, int N>
+class QuantizedRowHandler {
+
+public:
+    explicit QuantizedRowHandler(const BitmapRef<T, N> &output) : output(output) { }
+
+    bool operator()(int y, const float *pixels) {
+        T *dst = output(0, y);
+        for (int i = 0; i < N*output.width; ++i)
+            storePixelValue(dst[i], pixels[i]);
+        return true;
+    }
+
+private:
+    BitmapRef<T, N> output;
+
+};
+
+/// Passes the rows of a distance field to a RowWriter.
+template <int N>
+class WriterRowHandler {
+
+public:
+    explicit WriterRowHandler(RowWriter<N> &writer) : writer(writer) { }
+
+    bool operator()(int, const float *pixels) {
+        return writer.writeRow(pixels);
+    }
+
+private:
+    RowWriter<N> &writer;
+
+};
+
+/// Generates a distance field into a bitmap of integer pixels without a floating-point copy of the whole distance field.
+template <class ContourCombiner, typename T, int N, class Config>
+void generateQuantizedDistanceField(const BitmapRef<T, N> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const Config &config) {
+    if (hasPostProcessing(config)) {
+        QuantizedRowHandler<T, N> rowHandler(output);
+        generateDistanceFieldBands<ContourCombiner>(rowHandler, output.width, output.height, false, shape, range, scale, translate, config);
+    } else
+        generateDistanceField<ContourCombiner, T>(output, shape, range, scale, translate, config);
+}
+
+/// Generates a distance field row by row into writer.
+template <class ContourCombiner, int N, class Config>
+bool generateDistanceFieldRows(RowWriter<N> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const Config &config) {
+    WriterRowHandler<N> rowHandler(writer);
+    return generateDistanceFieldBands<ContourCombiner>(rowHandler, width, height, writer.topDown(), shape, range, scale, translate, config);
+}
+
+/// Orders job indices by decreasing estimated cost.
+class JobCostOrder {
+
+public:
+    explicit JobCostOrder(const std::vector<double> &costs) : costs(costs) { }
+
+    bool operator()(int a, int b) const {
+        return costs[a] > costs[b];
+    }
+
+private:
+    const std::vector<double> &costs;
+
+};
+
+/**
+ * Generates a batch of distance fields, each of which is processed as a whole by one thread, with the stages of the single-shape generator running serially on it.
+ * The jobs are dealt out in the order of decreasing estimated cost, the number of pixels times the number of edges, to the equal contiguous ranges of task indices
+ * that executors such as ThreadPool start each thread with, always to the range with the lowest total cost so far. Integer outputs are generated through
+ * a floating-point buffer kept by each thread for all of its jobs.
+ */
+template <typename T, int N, class Config>
+class JobBatchGenerator {
+
+public:
+    typedef void (*FloatGenerator)(const BitmapRef<float, N> &, const Shape &, double, const Vector2 &, const Vector2 &, const Config &);
+
+    JobBatchGenerator(FloatGenerator generate, const GeneratorJob<T, N> *jobs, int jobCount, const Config &config, int threadCount) :
+        generate(generate), jobs(jobs), order(jobCount), config(config), buffers(threadCount) {
+        // The shape-specific edge grid cannot be used for other shapes, and the executor's threads are already occupied by the batch
+        this->config.edgeGrid = NULL;
+        this->config.executor = &SerialExecutor::instance();
+        std::vector<double> costs(jobCount);
+        std::vector<int> sortedJobs(jobCount);
+        for (int i = 0; i < jobCount; ++i) {
+            costs[i] = (double) jobs[i].output.width*jobs[i].output.height*max(jobs[i].shape->edgeCount(), 1);
+            sortedJobs[i] = i;
+        }
+        std::stable_sort(sortedJobs.begin(), sortedJobs.end(), JobCostOrder(costs));
+        std::vector<int> rangeNext(threadCount), rangeEnd(threadCount);
+        std::vector<double> rangeCost(threadCount, 0.);
+        for (int i = 0; i < threadCount; ++i) {
+            rangeNext[i] = (int) ((long long) jobCount*i/threadCount);
+            rangeEnd[i] = (int) ((long long) jobCount*(i+1)/threadCount);
+        }
+        for (std::vector<int>::const_iterator job = sortedJobs.begin(); job != sortedJobs.end(); ++job) {
+            int range = -1;
+            for (int i = 0; i < threadCount; ++i)
+                if (rangeNext[i] < rangeEnd[i] && (range < 0 || rangeCost[i] < rangeCost[range]))
+                    range = i;
+            order[rangeNext[range]++] = *job;
+            rangeCost[range] += costs[*job];
+        }
+    }
+
+    int taskCount() const {
+        return (int) order.size();
+    }
+
+    void operator()(int index, int thread) {
+        generateJob(jobs[order[index]], buffers[thread]);
+    }
+
+private:
+    FloatGenerator generate;
+    const GeneratorJob<T, N> *jobs;
+    std::vector<int> order;
+    Config config;
+    std::vector<std::vector<float> > buffers;
+
+    void generateJob(const GeneratorJob<float, N> &job, std::vector<float> &) const {
+        generate(job.output, *job.shape, job.range, job.scale, job.translate, config);
+    }
+
+    template <typename U>
+    void generateJob(const GeneratorJob<U, N> &job, std::vector<float> &buffer) const {
+        int w = job.output.width, h = job.output.height;
+        if (!(w > 0 && h > 0))
+            return;
+        if (buffer.size() < (size_t) N*w*h)
+            buffer.resize(N*w*h);
+        BitmapRef<float, N> field(&buffer[0], w, h);
+        generate(field, *job.shape, job.range, job.scale, job.translate, config);
+        for (int y = 0; y < h; ++y) {
+            const float *src = field(0, y);
+            U *dst = job.output(0, y);
+            for (int i = 0; i < N*w; ++i)
+                storePixelValue(dst[i], src[i]);
+        }
+    }
+
+};
+
+/// Generates a batch of jobs with the executor of the configuration.
+template <typename T, int N, class Config>
+void generateJobBatch(typename JobBatchGenerator<T, N, Config>::FloatGenerator generate, const GeneratorJob<T, N> *jobs, int jobCount, const Config &config) {
+    if (jobCount <= 0)
+        return;
+    Executor &executor = resolveExecutor(config.executor);
+    JobBatchGenerator<T, N, Config> generator(generate, jobs, jobCount, config, executor.threadCount());
+    parallelFor(&executor, generator.taskCount(), generator);
+}
+
+void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
     else
-        generateDistanceField<SimpleContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate);
+        generateDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    if (config.scanlinePass)
+        distanceSignCorrection(output, shape, scale, translate, config.fillRule, config.executor);
 }
 
-void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport) {
-    if (overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate);
+void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateDistanceField<OverlappingContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
     else
-        generateDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate);
-    if (edgeThreshold > 0)
-        msdfErrorCorrection(output, edgeThreshold/(scale*range));
-    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport);
+        generateDistanceField<SimpleContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
+    if (config.scanlinePass)
+        distanceSignCorrection(output, shape, scale, translate, config.fillRule, config.executor);
 }
 
-void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport) {
-    if (overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate);
+void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
     else
-        generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate);
-    if (edgeThreshold > 0)
-        msdfErrorCorrection(output, edgeThreshold/(scale*range));
-    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport);
+        generateDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
+    if (config.edgeThreshold > 0)
+        msdfErrorCorrection(output, config.edgeThreshold/(scale*range), config.executor);
+    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, config);
+    if (config.scanlinePass) {
+        distanceSignCorrection(output, shape, scale, translate, config.fillRule, config.executor);
+        if (config.edgeThreshold > 0)
+            msdfErrorCorrection(output, config.edgeThreshold/(scale*range), config.executor);
+    }
+}
+
+void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    if (config.edgeThreshold > 0)
+        msdfErrorCorrection(output, config.edgeThreshold/(scale*range), config.executor);
+    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, config);
+    if (config.scanlinePass) {
+        distanceSignCorrection(output, shape, scale, translate, config.fillRule, config.executor);
+        if (config.edgeThreshold > 0)
+            msdfErrorCorrection(output, config.edgeThreshold/(scale*range), config.executor);
+    }
+}
+
+void generateSDF(const BitmapRef<byte, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generatePseudoSDF(const BitmapRef<byte, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generateMSDF(const BitmapRef<byte, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generateMTSDF(const BitmapRef<byte, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generateSDF(const BitmapRef<uint16_t, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generatePseudoSDF(const BitmapRef<uint16_t, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<PseudoDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generateMSDF(const BitmapRef<uint16_t, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+void generateMTSDF(const BitmapRef<uint16_t, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        generateQuantizedDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+    else
+        generateQuantizedDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, range, scale, translate, config);
+}
+
+bool generateSDF(RowWriter<1> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        return generateDistanceFieldRows<OverlappingContourCombiner<TrueDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+    else
+        return generateDistanceFieldRows<SimpleContourCombiner<TrueDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+}
+
+bool generatePseudoSDF(RowWriter<1> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config) {
+    if (config.overlapSupport)
+        return generateDistanceFieldRows<OverlappingContourCombiner<PseudoDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+    else
+        return generateDistanceFieldRows<SimpleContourCombiner<PseudoDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+}
+
+bool generateMSDF(RowWriter<3> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        return generateDistanceFieldRows<OverlappingContourCombiner<MultiDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+    else
+        return generateDistanceFieldRows<SimpleContourCombiner<MultiDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+}
+
+bool generateMTSDF(RowWriter<4> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config) {
+    if (config.overlapSupport)
+        return generateDistanceFieldRows<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+    else
+        return generateDistanceFieldRows<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(writer, width, height, shape, range, scale, translate, config);
+}
+
+void generateSDF(const GeneratorJob<float, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generateSDF, jobs, jobCount, config);
+}
+
+void generatePseudoSDF(const GeneratorJob<float, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generatePseudoSDF, jobs, jobCount, config);
+}
+
+void generateMSDF(const GeneratorJob<float, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMSDF, jobs, jobCount, config);
+}
+
+void generateMTSDF(const GeneratorJob<float, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMTSDF, jobs, jobCount, config);
+}
+
+void generateSDF(const GeneratorJob<byte, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generateSDF, jobs, jobCount, config);
+}
+
+void generatePseudoSDF(const GeneratorJob<byte, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generatePseudoSDF, jobs, jobCount, config);
+}
+
+void generateMSDF(const GeneratorJob<byte, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMSDF, jobs, jobCount, config);
+}
+
+void generateMTSDF(const GeneratorJob<byte, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMTSDF, jobs, jobCount, config);
+}
+
+void generateSDF(const GeneratorJob<uint16_t, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generateSDF, jobs, jobCount, config);
+}
+
+void generatePseudoSDF(const GeneratorJob<uint16_t, 1> *jobs, int jobCount, const GeneratorConfig &config) {
+    generateJobBatch(&generatePseudoSDF, jobs, jobCount, config);
+}
+
+void generateMSDF(const GeneratorJob<uint16_t, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMSDF, jobs, jobCount, config);
+}
+
+void generateMTSDF(const GeneratorJob<uint16_t, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config) {
+    generateJobBatch(&generateMTSDF, jobs, jobCount, config);
+}
+
+void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
+    generateSDF(output, shape, range, scale, translate, GeneratorConfig(overlapSupport));
+}
+
+void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
+    generatePseudoSDF(output, shape, range, scale, translate, GeneratorConfig(overlapSupport));
+}
+
+void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport) {
+    generateMSDF(output, shape, range, scale, translate, MSDFGeneratorConfig(overlapSupport, edgeThreshold));
+}
+
+void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport) {
+    generateMTSDF(output, shape, range, scale, translate, MSDFGeneratorConfig(overlapSupport, edgeThreshold));
 }
 
 // Legacy version
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include "arithmetics.hpp"
 
 namespace msdfgen {
@@ -15,4 +16,25 @@ inline float pixelByteToFloat(byte x) {
     return 1.f/255.f*float(x);
 }
 
+inline uint16_t pixelFloatToUint16(float x) {
+    return uint16_t(clamp(65536.f*x, 65535.f));
+}
+
+inline float pixelUint16ToFloat(uint16_t x) {
+    return 1.f/65535.f*float(x);
+}
+
+/// Stores the normalized value x in a pixel channel of the respective type.
+inline void storePixelValue(float &pixel, float x) {
+    pixel = x;
+}
+
+inline void storePixelValue(byte &pixel, float x) {
+    pixel = pixelFloatToByte(x);
+}
+
+inline void storePixelValue(uint16_t &pixel, float x) {
+    pixel = pixelFloatToUint16(x);
+}
+
 }
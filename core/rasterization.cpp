@@ -3,106 +3,245 @@
 
 #include <vector>
 #include "arithmetics.hpp"
+#include "ScanlineGenerator.h"
+
+// The number of rows processed by each task of the scanline passes
+#define RASTERIZATION_BAND_HEIGHT 16
 
 namespace msdfgen {
 
-void rasterize(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
-    Point2 p;
-    Scanline scanline;
-    for (int y = 0; y < output.height; ++y) {
-        int row = shape.inverseYAxis ? output.height-y-1 : y;
-        p.y = (y+.5)/scale.y-translate.y;
-        shape.scanline(scanline, p.y);
-        for (int x = 0; x < output.width; ++x) {
-            p.x = (x+.5)/scale.x-translate.x;
-            bool fill = scanline.filled(p.x, fillRule);
-            *output(x, row) = (float) fill;
-        }
+/// The scanline generators of the threads of a parallel loop over the rows of a bitmap, created when first needed.
+class RowScanlines {
+
+public:
+    RowScanlines(const Shape &shape, int threadCount) : shape(shape), threads(threadCount, (ThreadState *) NULL) { }
+
+    ~RowScanlines() {
+        for (std::vector<ThreadState *>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+            delete *thread;
     }
+
+    /// Returns the scanline at y, which remains valid until the next call by the same thread.
+    const Scanline &scanline(double y, int thread) {
+        if (!threads[thread])
+            threads[thread] = new ThreadState(shape);
+        threads[thread]->generator.scanline(threads[thread]->scanline, y);
+        return threads[thread]->scanline;
+    }
+
+private:
+    struct ThreadState {
+        ScanlineGenerator generator;
+        Scanline scanline;
+
+        explicit ThreadState(const Shape &shape) : generator(shape) { }
+    };
+
+    const Shape &shape;
+    std::vector<ThreadState *> threads;
+
+    RowScanlines(const RowScanlines &);
+    RowScanlines &operator=(const RowScanlines &);
+
+};
+
+static int bandCount(int height) {
+    return (height+RASTERIZATION_BAND_HEIGHT-1)/RASTERIZATION_BAND_HEIGHT;
 }
 
-void distanceSignCorrection(const BitmapRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
-    Point2 p;
-    Scanline scanline;
-    for (int y = 0; y < sdf.height; ++y) {
-        int row = shape.inverseYAxis ? sdf.height-y-1 : y;
-        p.y = (y+.5)/scale.y-translate.y;
-        shape.scanline(scanline, p.y);
-        for (int x = 0; x < sdf.width; ++x) {
-            p.x = (x+.5)/scale.x-translate.x;
-            bool fill = scanline.filled(p.x, fillRule);
-            float &sd = *sdf(x, row);
-            if ((sd > .5f) != fill)
-                sd = 1.f-sd;
+class Rasterizer {
+
+public:
+    Rasterizer(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, int threadCount) :
+        output(output), shape(shape), scale(scale), translate(translate), fillRule(fillRule), scanlines(shape, threadCount) { }
+
+    void operator()(int band, int thread) {
+        Point2 p;
+        for (int y = band*RASTERIZATION_BAND_HEIGHT, y1 = min(y+RASTERIZATION_BAND_HEIGHT, output.height); y < y1; ++y) {
+            int row = shape.inverseYAxis ? output.height-y-1 : y;
+            p.y = (y+.5)/scale.y-translate.y;
+            const Scanline &scanline = scanlines.scanline(p.y, thread);
+            for (int x = 0; x < output.width; ++x) {
+                p.x = (x+.5)/scale.x-translate.x;
+                bool fill = scanline.filled(p.x, fillRule);
+                *output(x, row) = (float) fill;
+            }
         }
     }
+
+private:
+    BitmapRef<float, 1> output;
+    const Shape &shape;
+    Vector2 scale, translate;
+    FillRule fillRule;
+    RowScanlines scanlines;
+
+};
+
+/// Returns the row of the shape's coordinate system which corresponds to the first row of the bitmap of height rows, which is row rowOffset of a larger bitmap of imageHeight rows.
+static int firstShapeRow(const Shape &shape, int rowOffset, int height, int imageHeight) {
+    return shape.inverseYAxis ? imageHeight-rowOffset-height : rowOffset;
 }
 
-template <int N>
-static void multiDistanceSignCorrection(const BitmapRef<float, N> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
-    int w = sdf.width, h = sdf.height;
-    if (!(w*h))
-        return;
-    Point2 p;
-    Scanline scanline;
-    bool ambiguous = false;
-    std::vector<char> matchMap;
-    matchMap.resize(w*h);
-    char *match = &matchMap[0];
-    for (int y = 0; y < h; ++y) {
-        int row = shape.inverseYAxis ? h-y-1 : y;
-        p.y = (y+.5)/scale.y-translate.y;
-        shape.scanline(scanline, p.y);
-        for (int x = 0; x < w; ++x) {
-            p.x = (x+.5)/scale.x-translate.x;
-            bool fill = scanline.filled(p.x, fillRule);
-            float *msd = sdf(x, row);
-            float sd = median(msd[0], msd[1], msd[2]);
-            if (sd == .5f)
-                ambiguous = true;
-            else if ((sd > .5f) != fill) {
-                msd[0] = 1.f-msd[0];
-                msd[1] = 1.f-msd[1];
-                msd[2] = 1.f-msd[2];
-                *match = -1;
-            } else
-                *match = 1;
-            if (N >= 4 && (msd[3] > .5f) != fill)
-                msd[3] = 1.f-msd[3];
-            ++match;
+class SignCorrector {
+
+public:
+    SignCorrector(const BitmapRef<float, 1> &sdf, int firstRow, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, int threadCount) :
+        sdf(sdf), firstRow(firstRow), shape(shape), scale(scale), translate(translate), fillRule(fillRule), scanlines(shape, threadCount) { }
+
+    void operator()(int band, int thread) {
+        Point2 p;
+        for (int y = band*RASTERIZATION_BAND_HEIGHT, y1 = min(y+RASTERIZATION_BAND_HEIGHT, sdf.height); y < y1; ++y) {
+            int row = shape.inverseYAxis ? sdf.height-y-1 : y;
+            p.y = (firstRow+y+.5)/scale.y-translate.y;
+            const Scanline &scanline = scanlines.scanline(p.y, thread);
+            for (int x = 0; x < sdf.width; ++x) {
+                p.x = (x+.5)/scale.x-translate.x;
+                bool fill = scanline.filled(p.x, fillRule);
+                float &sd = *sdf(x, row);
+                if ((sd > .5f) != fill)
+                    sd = 1.f-sd;
+            }
         }
     }
-    // This step is necessary to avoid artifacts when whole shape is inverted
-    if (ambiguous) {
-        match = &matchMap[0];
-        for (int y = 0; y < h; ++y) {
+
+private:
+    BitmapRef<float, 1> sdf;
+    int firstRow;
+    const Shape &shape;
+    Vector2 scale, translate;
+    FillRule fillRule;
+    RowScanlines scanlines;
+
+};
+
+/**
+ * Corrects the sign of a multi-channel distance field in two passes. The first one flips mismatched pixels and records in the match map whether each pixel
+ * matched the fill (1), was flipped (-1), or is ambiguous (0). The second one only reads the completed match map, so its rows are also independent.
+ */
+template <int N>
+class MultiSignCorrector {
+
+public:
+    /// If set, the ambiguous pixels are resolved, otherwise the first pass is performed.
+    bool resolveAmbiguous;
+
+    MultiSignCorrector(const BitmapRef<float, N> &sdf, int firstRow, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, int threadCount) :
+        resolveAmbiguous(false), sdf(sdf), firstRow(firstRow), shape(shape), scale(scale), translate(translate), fillRule(fillRule), scanlines(shape, threadCount),
+        matchMap(sdf.width*sdf.height), ambiguousBands(bandCount(sdf.height)) { }
+
+    /// Returns true if any pixel was found to be ambiguous by the first pass.
+    bool ambiguous() const {
+        for (std::vector<char>::const_iterator band = ambiguousBands.begin(); band != ambiguousBands.end(); ++band)
+            if (*band)
+                return true;
+        return false;
+    }
+
+    void operator()(int band, int thread) {
+        int w = sdf.width, h = sdf.height;
+        Point2 p;
+        for (int y = band*RASTERIZATION_BAND_HEIGHT, y1 = min(y+RASTERIZATION_BAND_HEIGHT, h); y < y1; ++y) {
             int row = shape.inverseYAxis ? h-y-1 : y;
-            for (int x = 0; x < w; ++x) {
-                if (!*match) {
-                    int neighborMatch = 0;
-                    if (x > 0) neighborMatch += *(match-1);
-                    if (x < w-1) neighborMatch += *(match+1);
-                    if (y > 0) neighborMatch += *(match-w);
-                    if (y < h-1) neighborMatch += *(match+w);
-                    if (neighborMatch < 0) {
-                        float *msd = sdf(x, row);
+            char *match = &matchMap[w*y];
+            if (resolveAmbiguous) {
+                // This step is necessary to avoid artifacts when whole shape is inverted
+                for (int x = 0; x < w; ++x) {
+                    if (!*match) {
+                        int neighborMatch = 0;
+                        if (x > 0) neighborMatch += *(match-1);
+                        if (x < w-1) neighborMatch += *(match+1);
+                        if (y > 0) neighborMatch += *(match-w);
+                        if (y < h-1) neighborMatch += *(match+w);
+                        if (neighborMatch < 0) {
+                            float *msd = sdf(x, row);
+                            msd[0] = 1.f-msd[0];
+                            msd[1] = 1.f-msd[1];
+                            msd[2] = 1.f-msd[2];
+                        }
+                    }
+                    ++match;
+                }
+            } else {
+                p.y = (firstRow+y+.5)/scale.y-translate.y;
+                const Scanline &scanline = scanlines.scanline(p.y, thread);
+                for (int x = 0; x < w; ++x) {
+                    p.x = (x+.5)/scale.x-translate.x;
+                    bool fill = scanline.filled(p.x, fillRule);
+                    float *msd = sdf(x, row);
+                    float sd = median(msd[0], msd[1], msd[2]);
+                    if (sd == .5f)
+                        ambiguousBands[band] = true;
+                    else if ((sd > .5f) != fill) {
                         msd[0] = 1.f-msd[0];
                         msd[1] = 1.f-msd[1];
                         msd[2] = 1.f-msd[2];
-                    }
+                        *match = -1;
+                    } else
+                        *match = 1;
+                    if (N >= 4 && (msd[3] > .5f) != fill)
+                        msd[3] = 1.f-msd[3];
+                    ++match;
                 }
-                ++match;
             }
         }
     }
+
+private:
+    BitmapRef<float, N> sdf;
+    int firstRow;
+    const Shape &shape;
+    Vector2 scale, translate;
+    FillRule fillRule;
+    RowScanlines scanlines;
+    std::vector<char> matchMap;
+    std::vector<char> ambiguousBands;
+
+};
+
+void rasterize(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    Executor &resolvedExecutor = resolveExecutor(executor);
+    Rasterizer rasterizer(output, shape, scale, translate, fillRule, resolvedExecutor.threadCount());
+    parallelFor(&resolvedExecutor, bandCount(output.height), rasterizer);
+}
+
+void distanceSignCorrection(const BitmapRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    distanceSignCorrection(sdf, 0, sdf.height, shape, scale, translate, fillRule, executor);
+}
+
+template <int N>
+static void multiDistanceSignCorrection(const BitmapRef<float, N> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    if (!(sdf.width*sdf.height))
+        return;
+    Executor &resolvedExecutor = resolveExecutor(executor);
+    MultiSignCorrector<N> signCorrector(sdf, firstShapeRow(shape, rowOffset, sdf.height, imageHeight), shape, scale, translate, fillRule, resolvedExecutor.threadCount());
+    parallelFor(&resolvedExecutor, bandCount(sdf.height), signCorrector);
+    if (signCorrector.ambiguous()) {
+        signCorrector.resolveAmbiguous = true;
+        parallelFor(&resolvedExecutor, bandCount(sdf.height), signCorrector);
+    }
+}
+
+void distanceSignCorrection(const BitmapRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    multiDistanceSignCorrection(sdf, 0, sdf.height, shape, scale, translate, fillRule, executor);
+}
+
+void distanceSignCorrection(const BitmapRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    multiDistanceSignCorrection(sdf, 0, sdf.height, shape, scale, translate, fillRule, executor);
+}
+
+void distanceSignCorrection(const BitmapRef<float, 1> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    Executor &resolvedExecutor = resolveExecutor(executor);
+    SignCorrector signCorrector(sdf, firstShapeRow(shape, rowOffset, sdf.height, imageHeight), shape, scale, translate, fillRule, resolvedExecutor.threadCount());
+    parallelFor(&resolvedExecutor, bandCount(sdf.height), signCorrector);
 }
 
-void distanceSignCorrection(const BitmapRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
-    multiDistanceSignCorrection(sdf, shape, scale, translate, fillRule);
+void distanceSignCorrection(const BitmapRef<float, 3> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    multiDistanceSignCorrection(sdf, rowOffset, imageHeight, shape, scale, translate, fillRule, executor);
 }
 
-void distanceSignCorrection(const BitmapRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
-    multiDistanceSignCorrection(sdf, shape, scale, translate, fillRule);
+void distanceSignCorrection(const BitmapRef<float, 4> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, Executor *executor) {
+    multiDistanceSignCorrection(sdf, rowOffset, imageHeight, shape, scale, translate, fillRule, executor);
 }
 
 }
@@ -5,14 +5,19 @@
 #include "Scanline.h"
 #include "Shape.h"
 #include "BitmapRef.hpp"
+#include "Executor.h"
 
 namespace msdfgen {
 
-/// Rasterizes the shape into a monochrome bitmap.
-void rasterize(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+/// Rasterizes the shape into a monochrome bitmap. Runs on executor, or the default executor if it is NULL.
+void rasterize(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
 /// Fixes the sign of the input signed distance field, so that it matches the shape's rasterized fill.
-void distanceSignCorrection(const BitmapRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
-void distanceSignCorrection(const BitmapRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
-void distanceSignCorrection(const BitmapRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void distanceSignCorrection(const BitmapRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
+void distanceSignCorrection(const BitmapRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
+void distanceSignCorrection(const BitmapRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
+/// Fixes the sign of a horizontal band of rows of a larger distance field of imageHeight rows, whose first row is row rowOffset of the whole. Ambiguous pixels in the rows at the edges of the band which are not edges of the whole may be resolved differently than in the whole.
+void distanceSignCorrection(const BitmapRef<float, 1> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
+void distanceSignCorrection(const BitmapRef<float, 3> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
+void distanceSignCorrection(const BitmapRef<float, 4> &sdf, int rowOffset, int imageHeight, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO, Executor *executor = NULL);
 
 }
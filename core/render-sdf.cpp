@@ -1,9 +1,12 @@
 
 #include "render-sdf.h"
 
+#include <vector>
 #include "arithmetics.hpp"
 #include "pixel-conversion.hpp"
-#include "bitmap-interpolation.hpp"
+
+// The number of rows rendered by each task
+#define RENDER_BAND_HEIGHT 16
 
 namespace msdfgen {
 
@@ -13,96 +16,202 @@ static float distVal(float dist, double pxRange, float midValue) {
     return (float) clamp((dist-midValue)*pxRange+.5);
 }
 
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
+/**
+ * Renders bands of RENDER_BAND_HEIGHT rows of an M-channel output from an N-channel distance field. The bilinear sampling positions are separable,
+ * so the texel columns and weights are precomputed for each output column, and the source rows interpolated horizontally are kept by each thread
+ * for the following output rows sampling the same ones. Weights of zero, which occur for integer scale ratios, reduce to reading the nearest texel.
+ */
+template <typename T, int M, int N>
+class SDFRenderer {
+
+public:
+    SDFRenderer(const BitmapRef<T, M> &output, const BitmapConstRef<float, N> &sdf, double pxRange, float midValue, int threadCount) :
+        output(output), sdf(sdf), scale((double) sdf.width/output.width, (double) sdf.height/output.height),
+        pxRange(pxRange*(double) (output.width+output.height)/(sdf.width+sdf.height)), midValue(midValue),
+        left(output.width), right(output.width), lr(output.width), nearestColumns(true), threads(threadCount, (ThreadState *) NULL) {
         for (int x = 0; x < output.width; ++x) {
-            float sd;
-            interpolate(&sd, sdf, scale*Point2(x+.5, y+.5));
-            *output(x, y) = distVal(sd, pxRange, midValue);
+            double pos = scale.x*(x+.5)-.5;
+            int l = (int) floor(pos);
+            lr[x] = pos-l;
+            left[x] = clamp(l, sdf.width-1), right[x] = clamp(l+1, sdf.width-1);
+            nearestColumns &= lr[x] == 0;
         }
-}
+    }
 
-void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
-        for (int x = 0; x < output.width; ++x) {
-            float sd;
-            interpolate(&sd, sdf, scale*Point2(x+.5, y+.5));
-            float v = distVal(sd, pxRange, midValue);
-            output(x, y)[0] = v;
-            output(x, y)[1] = v;
-            output(x, y)[2] = v;
+    ~SDFRenderer() {
+        for (typename std::vector<ThreadState *>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+            delete *thread;
+    }
+
+    int bandCount() const {
+        return (output.height+RENDER_BAND_HEIGHT-1)/RENDER_BAND_HEIGHT;
+    }
+
+    void operator()(int band, int thread) {
+        if (!threads[thread])
+            threads[thread] = new ThreadState(N*output.width);
+        ThreadState &state = *threads[thread];
+        for (int y = band*RENDER_BAND_HEIGHT, y1 = min(y+RENDER_BAND_HEIGHT, output.height); y < y1; ++y) {
+            double pos = scale.y*(y+.5)-.5;
+            int b = (int) floor(pos);
+            double bt = pos-b;
+            int t = clamp(b+1, sdf.height-1);
+            b = clamp(b, sdf.height-1);
+            const float *bottom = sourceRow(state, b, -1);
+            T *out = output(0, y);
+            if (bt == 0) {
+                for (int x = 0; x < output.width; ++x, out += M)
+                    renderPixel(out, bottom+N*x);
+            } else {
+                const float *top = sourceRow(state, t, b);
+                float sd[N];
+                for (int x = 0; x < output.width; ++x, out += M) {
+                    for (int i = 0; i < N; ++i)
+                        sd[i] = mix(bottom[N*x+i], top[N*x+i], bt);
+                    renderPixel(out, sd);
+                }
+            }
         }
-}
+    }
 
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
-        for (int x = 0; x < output.width; ++x) {
-            float sd[3];
-            interpolate(sd, sdf, scale*Point2(x+.5, y+.5));
-            *output(x, y) = distVal(median(sd[0], sd[1], sd[2]), pxRange, midValue);
+private:
+    /// Two source rows interpolated horizontally at the output columns, and their indices.
+    struct ThreadState {
+        std::vector<float> rows[2];
+        int rowIndex[2];
+
+        explicit ThreadState(int rowLength) {
+            rows[0].resize(rowLength), rows[1].resize(rowLength);
+            rowIndex[0] = -1, rowIndex[1] = -1;
         }
-}
+    };
 
-void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
-        for (int x = 0; x < output.width; ++x) {
-            float sd[3];
-            interpolate(sd, sdf, scale*Point2(x+.5, y+.5));
-            output(x, y)[0] = distVal(sd[0], pxRange, midValue);
-            output(x, y)[1] = distVal(sd[1], pxRange, midValue);
-            output(x, y)[2] = distVal(sd[2], pxRange, midValue);
+    BitmapRef<T, M> output;
+    BitmapConstRef<float, N> sdf;
+    Vector2 scale;
+    double pxRange;
+    float midValue;
+    std::vector<int> left, right;
+    std::vector<double> lr;
+    bool nearestColumns;
+    std::vector<ThreadState *> threads;
+
+    /// Returns source row y interpolated horizontally, which does not replace the row with index keep.
+    const float *sourceRow(ThreadState &state, int y, int keep) const {
+        if (state.rowIndex[0] == y)
+            return &state.rows[0][0];
+        if (state.rowIndex[1] == y)
+            return &state.rows[1][0];
+        int slot = state.rowIndex[0] == keep ? 1 : 0;
+        float *row = &state.rows[slot][0];
+        const float *texels = sdf(0, y);
+        if (nearestColumns) {
+            for (int x = 0; x < output.width; ++x)
+                for (int i = 0; i < N; ++i)
+                    row[N*x+i] = texels[N*left[x]+i];
+        } else {
+            for (int x = 0; x < output.width; ++x)
+                for (int i = 0; i < N; ++i)
+                    row[N*x+i] = mix(texels[N*left[x]+i], texels[N*right[x]+i], lr[x]);
         }
-}
+        state.rowIndex[slot] = y;
+        return row;
+    }
 
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
-        for (int x = 0; x < output.width; ++x) {
-            float sd[4];
-            interpolate(sd, sdf, scale*Point2(x+.5, y+.5));
-            *output(x, y) = distVal(median(sd[0], sd[1], sd[2]), pxRange, midValue);
+    void renderPixel(T *out, const float *sd) const {
+        if (N == 1) {
+            float v = distVal(sd[0], pxRange, midValue);
+            for (int i = 0; i < M; ++i)
+                storePixelValue(out[i], v);
+        } else if (M == 1)
+            storePixelValue(out[0], distVal(median(sd[0], sd[1], sd[2]), pxRange, midValue));
+        else {
+            for (int i = 0; i < M; ++i)
+                storePixelValue(out[i], distVal(sd[i], pxRange, midValue));
         }
+    }
+
+};
+
+template <typename T, int M, int N>
+static void renderSDFInner(const BitmapRef<T, M> &output, const BitmapConstRef<float, N> &sdf, double pxRange, float midValue, Executor *executor) {
+    if (!(sdf.width > 0 && sdf.height > 0 && output.width > 0 && output.height > 0))
+        return;
+    Executor &resolvedExecutor = resolveExecutor(executor);
+    SDFRenderer<T, M, N> renderer(output, sdf, pxRange, midValue, resolvedExecutor.threadCount());
+    parallelFor(&resolvedExecutor, renderer.bandCount(), renderer);
 }
 
-void renderSDF(const BitmapRef<float, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue) {
-    Vector2 scale((double) sdf.width/output.width, (double) sdf.height/output.height);
-    pxRange *= (double) (output.width+output.height)/(sdf.width+sdf.height);
-    for (int y = 0; y < output.height; ++y)
-        for (int x = 0; x < output.width; ++x) {
-            float sd[4];
-            interpolate(sd, sdf, scale*Point2(x+.5, y+.5));
-            output(x, y)[0] = distVal(sd[0], pxRange, midValue);
-            output(x, y)[1] = distVal(sd[1], pxRange, midValue);
-            output(x, y)[2] = distVal(sd[2], pxRange, midValue);
-            output(x, y)[3] = distVal(sd[3], pxRange, midValue);
-        }
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<float, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
+}
+
+void renderSDF(const BitmapRef<byte, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange, float midValue, Executor *executor) {
+    renderSDFInner(output, sdf, pxRange, midValue, executor);
 }
 
 void simulate8bit(const BitmapRef<float, 1> &bitmap) {
-    const float *end = bitmap.pixels+1*bitmap.width*bitmap.height;
-    for (float *p = bitmap.pixels; p < end; ++p)
-        *p = pixelByteToFloat(pixelFloatToByte(*p));
+    for (int y = 0; y < bitmap.height; ++y) {
+        float *p = bitmap(0, y);
+        for (float *end = p+1*bitmap.width; p < end; ++p)
+            *p = pixelByteToFloat(pixelFloatToByte(*p));
+    }
 }
 
 void simulate8bit(const BitmapRef<float, 3> &bitmap) {
-    const float *end = bitmap.pixels+3*bitmap.width*bitmap.height;
-    for (float *p = bitmap.pixels; p < end; ++p)
-        *p = pixelByteToFloat(pixelFloatToByte(*p));
+    for (int y = 0; y < bitmap.height; ++y) {
+        float *p = bitmap(0, y);
+        for (float *end = p+3*bitmap.width; p < end; ++p)
+            *p = pixelByteToFloat(pixelFloatToByte(*p));
+    }
 }
 
 void simulate8bit(const BitmapRef<float, 4> &bitmap) {
-    const float *end = bitmap.pixels+4*bitmap.width*bitmap.height;
-    for (float *p = bitmap.pixels; p < end; ++p)
-        *p = pixelByteToFloat(pixelFloatToByte(*p));
+    for (int y = 0; y < bitmap.height; ++y) {
+        float *p = bitmap(0, y);
+        for (float *end = p+4*bitmap.width; p < end; ++p)
+            *p = pixelByteToFloat(pixelFloatToByte(*p));
+    }
 }
 
 }
@@ -3,16 +3,23 @@
 
 #include "Vector2.h"
 #include "BitmapRef.hpp"
+#include "Executor.h"
 
 namespace msdfgen {
 
-/// Reconstructs the shape's appearance into output from the distance field sdf.
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f);
-void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f);
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f);
-void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f);
-void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f);
-void renderSDF(const BitmapRef<float, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f);
+/// Reconstructs the shape's appearance into output from the distance field sdf. Runs on executor, or the default executor if it is NULL.
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<float, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<float, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<float, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 3> &output, const BitmapConstRef<float, 1> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 3> &output, const BitmapConstRef<float, 3> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 1> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
+void renderSDF(const BitmapRef<byte, 4> &output, const BitmapConstRef<float, 4> &sdf, double pxRange = 0, float midValue = .5f, Executor *executor = NULL);
 
 /// Snaps the values of the floating-point bitmaps into one of the 256 values representable in a standard 8-bit bitmap.
 void simulate8bit(const BitmapRef<float, 1> &bitmap);
@@ -4,6 +4,7 @@
 #include "save-tiff.h"
 
 #include <cstdio>
+#include <vector>
 
 #ifdef MSDFGEN_USE_CPP11
     #include <cstdint>
@@ -17,164 +18,215 @@
 namespace msdfgen {
 
 template <typename T>
-static bool writeValue(FILE *file, T value) {
-    return fwrite(&value, sizeof(T), 1, file) == 1;
+static void writeValue(std::vector<uint8_t> &header, T value) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    header.insert(header.end(), bytes, bytes+sizeof(T));
 }
 template <typename T>
-static void writeValueRepeated(FILE *file, T value, int times) {
+static void writeValueRepeated(std::vector<uint8_t> &header, T value, int times) {
     for (int i = 0; i < times; ++i)
-        writeValue(file, value);
+        writeValue(header, value);
 }
 
+/// Assembles the header in memory and writes it to the file at once.
 static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
+    std::vector<uint8_t> header;
+    header.reserve(0x00d2u+12*channels);
     #ifdef __BIG_ENDIAN__
-        writeValue<uint16_t>(file, 0x4d4du);
+        writeValue<uint16_t>(header, 0x4d4du);
     #else
-        writeValue<uint16_t>(file, 0x4949u);
+        writeValue<uint16_t>(header, 0x4949u);
     #endif
-    writeValue<uint16_t>(file, 42);
-    writeValue<uint32_t>(file, 0x0008u); // Offset of first IFD
+    writeValue<uint16_t>(header, 42);
+    writeValue<uint32_t>(header, 0x0008u); // Offset of first IFD
     // Offset = 0x0008
 
-    writeValue<uint16_t>(file, 15); // Number of IFD entries
+    writeValue<uint16_t>(header, 15); // Number of IFD entries
 
     // ImageWidth
-    writeValue<uint16_t>(file, 0x0100u);
-    writeValue<uint16_t>(file, 0x0004u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<int32_t>(file, width);
+    writeValue<uint16_t>(header, 0x0100u);
+    writeValue<uint16_t>(header, 0x0004u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<int32_t>(header, width);
     // ImageLength
-    writeValue<uint16_t>(file, 0x0101u);
-    writeValue<uint16_t>(file, 0x0004u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<int32_t>(file, height);
+    writeValue<uint16_t>(header, 0x0101u);
+    writeValue<uint16_t>(header, 0x0004u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<int32_t>(header, height);
     // BitsPerSample
-    writeValue<uint16_t>(file, 0x0102u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, channels);
+    writeValue<uint16_t>(header, 0x0102u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00c2u); // Offset of 32, 32, ...
+        writeValue<uint32_t>(header, 0x00c2u); // Offset of 32, 32, ...
     else {
-        writeValue<uint16_t>(file, 32);
-        writeValue<uint16_t>(file, 0);
+        writeValue<uint16_t>(header, 32);
+        writeValue<uint16_t>(header, 0);
     }
     // Compression
-    writeValue<uint16_t>(file, 0x0103u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint16_t>(file, 1);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(header, 0x0103u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint16_t>(header, 1);
+    writeValue<uint16_t>(header, 0);
     // PhotometricInterpretation
-    writeValue<uint16_t>(file, 0x0106u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint16_t>(file, channels >= 3 ? 2 : 1);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(header, 0x0106u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint16_t>(header, channels >= 3 ? 2 : 1);
+    writeValue<uint16_t>(header, 0);
     // StripOffsets
-    writeValue<uint16_t>(file, 0x0111u);
-    writeValue<uint16_t>(file, 0x0004u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00d2u+(channels > 1)*channels*12); // Offset of pixel data
+    writeValue<uint16_t>(header, 0x0111u);
+    writeValue<uint16_t>(header, 0x0004u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint32_t>(header, 0x00d2u+(channels > 1)*channels*12); // Offset of pixel data
     // SamplesPerPixel
-    writeValue<uint16_t>(file, 0x0115u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint16_t>(file, channels);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(header, 0x0115u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint16_t>(header, channels);
+    writeValue<uint16_t>(header, 0);
     // RowsPerStrip
-    writeValue<uint16_t>(file, 0x0116u);
-    writeValue<uint16_t>(file, 0x0004u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<int32_t>(file, height);
+    writeValue<uint16_t>(header, 0x0116u);
+    writeValue<uint16_t>(header, 0x0004u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<int32_t>(header, height);
     // StripByteCounts
-    writeValue<uint16_t>(file, 0x0117u);
-    writeValue<uint16_t>(file, 0x0004u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<int32_t>(file, sizeof(float)*channels*width*height);
+    writeValue<uint16_t>(header, 0x0117u);
+    writeValue<uint16_t>(header, 0x0004u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<int32_t>(header, sizeof(float)*channels*width*height);
     // XResolution
-    writeValue<uint16_t>(file, 0x011au);
-    writeValue<uint16_t>(file, 0x0005u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00c2u+(channels > 1)*channels*2); // Offset of 300, 1
+    writeValue<uint16_t>(header, 0x011au);
+    writeValue<uint16_t>(header, 0x0005u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint32_t>(header, 0x00c2u+(channels > 1)*channels*2); // Offset of 300, 1
     // YResolution
-    writeValue<uint16_t>(file, 0x011bu);
-    writeValue<uint16_t>(file, 0x0005u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00cau+(channels > 1)*channels*2); // Offset of 300, 1
+    writeValue<uint16_t>(header, 0x011bu);
+    writeValue<uint16_t>(header, 0x0005u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint32_t>(header, 0x00cau+(channels > 1)*channels*2); // Offset of 300, 1
     // ResolutionUnit
-    writeValue<uint16_t>(file, 0x0128u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, 1);
-    writeValue<uint16_t>(file, 2);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(header, 0x0128u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, 1);
+    writeValue<uint16_t>(header, 2);
+    writeValue<uint16_t>(header, 0);
     // SampleFormat
-    writeValue<uint16_t>(file, 0x0153u);
-    writeValue<uint16_t>(file, 0x0003u);
-    writeValue<uint32_t>(file, channels);
+    writeValue<uint16_t>(header, 0x0153u);
+    writeValue<uint16_t>(header, 0x0003u);
+    writeValue<uint32_t>(header, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*2); // Offset of 3, 3, ...
+        writeValue<uint32_t>(header, 0x00d2u+channels*2); // Offset of 3, 3, ...
     else {
-        writeValue<uint16_t>(file, 3);
-        writeValue<uint16_t>(file, 0);
+        writeValue<uint16_t>(header, 3);
+        writeValue<uint16_t>(header, 0);
     }
     // SMinSampleValue
-    writeValue<uint16_t>(file, 0x0154u);
-    writeValue<uint16_t>(file, 0x000bu);
-    writeValue<uint32_t>(file, channels);
+    writeValue<uint16_t>(header, 0x0154u);
+    writeValue<uint16_t>(header, 0x000bu);
+    writeValue<uint32_t>(header, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*4); // Offset of 0.f, 0.f, ...
+        writeValue<uint32_t>(header, 0x00d2u+channels*4); // Offset of 0.f, 0.f, ...
     else
-        writeValue<float>(file, 0.f);
+        writeValue<float>(header, 0.f);
     // SMaxSampleValue
-    writeValue<uint16_t>(file, 0x0155u);
-    writeValue<uint16_t>(file, 0x000bu);
-    writeValue<uint32_t>(file, channels);
+    writeValue<uint16_t>(header, 0x0155u);
+    writeValue<uint16_t>(header, 0x000bu);
+    writeValue<uint32_t>(header, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*8); // Offset of 1.f, 1.f, ...
+        writeValue<uint32_t>(header, 0x00d2u+channels*8); // Offset of 1.f, 1.f, ...
     else
-        writeValue<float>(file, 1.f);
+        writeValue<float>(header, 1.f);
     // Offset = 0x00be
 
-    writeValue<uint32_t>(file, 0);
+    writeValue<uint32_t>(header, 0);
 
     if (channels > 1) {
         // 0x00c2 BitsPerSample data
-        writeValueRepeated<uint16_t>(file, 32, channels);
+        writeValueRepeated<uint16_t>(header, 32, channels);
         // 0x00c2 + 2*N XResolution data
-        writeValue<uint32_t>(file, 300);
-        writeValue<uint32_t>(file, 1);
+        writeValue<uint32_t>(header, 300);
+        writeValue<uint32_t>(header, 1);
         // 0x00ca + 2*N YResolution data
-        writeValue<uint32_t>(file, 300);
-        writeValue<uint32_t>(file, 1);
+        writeValue<uint32_t>(header, 300);
+        writeValue<uint32_t>(header, 1);
         // 0x00d2 + 2*N SampleFormat data
-        writeValueRepeated<uint16_t>(file, 3, channels);
+        writeValueRepeated<uint16_t>(header, 3, channels);
         // 0x00d2 + 4*N SMinSampleValue data
-        writeValueRepeated<float>(file, 0.f, channels);
+        writeValueRepeated<float>(header, 0.f, channels);
         // 0x00d2 + 8*N SMaxSampleValue data
-        writeValueRepeated<float>(file, 1.f, channels);
+        writeValueRepeated<float>(header, 1.f, channels);
         // Offset = 0x00d2 + 12*N
     } else {
         // 0x00c2 XResolution data
-        writeValue<uint32_t>(file, 300);
-        writeValue<uint32_t>(file, 1);
+        writeValue<uint32_t>(header, 300);
+        writeValue<uint32_t>(header, 1);
         // 0x00ca YResolution data
-        writeValue<uint32_t>(file, 300);
-        writeValue<uint32_t>(file, 1);
+        writeValue<uint32_t>(header, 300);
+        writeValue<uint32_t>(header, 1);
         // Offset = 0x00d2
     }
 
+    return fwrite(&header[0], 1, header.size(), file) == header.size();
+}
+
+template <int N>
+TiffRowWriter<N>::TiffRowWriter() : file(NULL), width(0), rowsLeft(0), failed(false) { }
+
+template <int N>
+TiffRowWriter<N>::~TiffRowWriter() {
+    if (file)
+        fclose(file);
+}
+
+template <int N>
+bool TiffRowWriter<N>::open(const char *filename, int width, int height) {
+    close();
+    file = fopen(filename, "wb");
+    if (!file)
+        return false;
+    this->width = width;
+    rowsLeft = height;
+    failed = !writeTiffHeader(file, width, height, N);
+    return !failed;
+}
+
+template <int N>
+bool TiffRowWriter<N>::close() {
+    if (!file)
+        return false;
+    bool success = !fclose(file) && !failed && !rowsLeft;
+    file = NULL;
+    return success;
+}
+
+template <int N>
+bool TiffRowWriter<N>::topDown() const {
     return true;
 }
 
+template <int N>
+bool TiffRowWriter<N>::writeRow(const float *pixels) {
+    if (!(file && rowsLeft > 0) || failed)
+        return false;
+    --rowsLeft;
+    failed = (int) fwrite(pixels, sizeof(float), N*width, file) != N*width;
+    return !failed;
+}
+
+template class TiffRowWriter<1>;
+template class TiffRowWriter<3>;
+template class TiffRowWriter<4>;
+
 template <int N>
 bool saveTiffFloat(const BitmapConstRef<float, N> &bitmap, const char *filename) {
-    FILE *file = fopen(filename, "wb");
-    if (!file)
+    TiffRowWriter<N> writer;
+    if (!writer.open(filename, bitmap.width, bitmap.height))
         return false;
-    writeTiffHeader(file, bitmap.width, bitmap.height, N);
     for (int y = bitmap.height-1; y >= 0; --y)
-        fwrite(bitmap(0, y), sizeof(float), N*bitmap.width, file);
-    return !fclose(file);
+        writer.writeRow(bitmap(0, y));
+    return writer.close();
 }
 
 bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename) {
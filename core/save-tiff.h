@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <cstdio>
 #include "BitmapRef.hpp"
+#include "RowWriter.h"
 
 namespace msdfgen {
 
@@ -10,4 +12,28 @@ bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstRef<float, 3> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstRef<float, 4> &bitmap, const char *filename);
 
+/// Writes an uncompressed floating-point TIFF file row by row, from the top row down.
+template <int N>
+class TiffRowWriter : public RowWriter<N> {
+
+public:
+    TiffRowWriter();
+    ~TiffRowWriter();
+    /// Creates the file and writes its header.
+    bool open(const char *filename, int width, int height);
+    /// Closes the file. Returns false if it could not be written completely.
+    bool close();
+    bool topDown() const;
+    bool writeRow(const float *pixels);
+
+private:
+    FILE *file;
+    int width, rowsLeft;
+    bool failed;
+
+    TiffRowWriter(const TiffRowWriter &);
+    TiffRowWriter &operator=(const TiffRowWriter &);
+
+};
+
 }
@@ -3,12 +3,20 @@
 
 #include <cmath>
 #include "arithmetics.hpp"
+#include "ScanlineGenerator.h"
+
+// The number of rows processed by each task of the error estimation
+#define ERROR_ESTIMATION_BAND_HEIGHT 8
+// The number of rows between comparisons of the estimated error to its limit
+#define ERROR_ESTIMATION_ROUND_HEIGHT 128
 
 namespace msdfgen {
 
-void scanlineSDF(Scanline &line, const BitmapConstRef<float, 1> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
+/// Constructs the scanline of a single-channel SDF using intersections as a buffer.
+static void scanlineSDF(Scanline &line, std::vector<Scanline::Intersection> &intersections, const BitmapConstRef<float, 1> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
+    intersections.clear();
     if (!(sdf.width > 0 && sdf.height > 0))
-        return line.setIntersections(std::vector<Scanline::Intersection>());
+        return line.setIntersections(intersections);
     double pixelY = clamp(scale.x*(y+translate.y)-.5, double(sdf.height-1));
     if (inverseYAxis)
         pixelY = sdf.height-1-pixelY;
@@ -21,7 +29,6 @@ void scanlineSDF(Scanline &line, const BitmapConstRef<float, 1> &sdf, const Vect
         bt = 1;
     }
     bool inside = false;
-    std::vector<Scanline::Intersection> intersections;
     float lv, rv = mix(*sdf(0, b), *sdf(0, t), bt);
     if ((inside = rv > .5f)) {
         Scanline::Intersection intersection = { -1e240, 1 };
@@ -38,17 +45,15 @@ void scanlineSDF(Scanline &line, const BitmapConstRef<float, 1> &sdf, const Vect
             }
         }
     }
-#ifdef MSDFGEN_USE_CPP11
-    line.setIntersections((std::vector<Scanline::Intersection> &&) intersections);
-#else
     line.setIntersections(intersections);
-#endif
 }
 
+/// Constructs the scanline of a multi-channel SDF using intersections as a buffer.
 template <int N>
-void scanlineMSDF(Scanline &line, const BitmapConstRef<float, N> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
+static void scanlineSDF(Scanline &line, std::vector<Scanline::Intersection> &intersections, const BitmapConstRef<float, N> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
+    intersections.clear();
     if (!(sdf.width > 0 && sdf.height > 0))
-        return line.setIntersections(std::vector<Scanline::Intersection>());
+        return line.setIntersections(intersections);
     double pixelY = clamp(scale.x*(y+translate.y)-.5, double(sdf.height-1));
     if (inverseYAxis)
         pixelY = sdf.height-1-pixelY;
@@ -61,7 +66,6 @@ void scanlineMSDF(Scanline &line, const BitmapConstRef<float, N> &sdf, const Vec
         bt = 1;
     }
     bool inside = false;
-    std::vector<Scanline::Intersection> intersections;
     float lv[3], rv[3];
     rv[0] = mix(sdf(0, b)[0], sdf(0, t)[0], bt);
     rv[1] = mix(sdf(0, b)[1], sdf(0, t)[1], bt);
@@ -117,50 +121,114 @@ void scanlineMSDF(Scanline &line, const BitmapConstRef<float, N> &sdf, const Vec
             inside = !inside;
         }
     }
-#ifdef MSDFGEN_USE_CPP11
-    line.setIntersections((std::vector<Scanline::Intersection> &&) intersections);
-#else
     line.setIntersections(intersections);
-#endif
 }
 
+void scanlineSDF(Scanline &line, const BitmapConstRef<float, 1> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
+    std::vector<Scanline::Intersection> intersections;
+    scanlineSDF(line, intersections, sdf, scale, translate, inverseYAxis, y);
+}
 void scanlineSDF(Scanline &line, const BitmapConstRef<float, 3> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
-    scanlineMSDF(line, sdf, scale, translate, inverseYAxis, y);
+    std::vector<Scanline::Intersection> intersections;
+    scanlineSDF(line, intersections, sdf, scale, translate, inverseYAxis, y);
 }
 void scanlineSDF(Scanline &line, const BitmapConstRef<float, 4> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y) {
-    scanlineMSDF(line, sdf, scale, translate, inverseYAxis, y);
+    std::vector<Scanline::Intersection> intersections;
+    scanlineSDF(line, intersections, sdf, scale, translate, inverseYAxis, y);
 }
 
+/**
+ * Evaluates the fill error of the sub-rows of bands of ERROR_ESTIMATION_BAND_HEIGHT rows, starting at firstRow, with a scanline generator and buffers per thread.
+ * The error of each sub-row is stored separately, so that they may be summed up in the same order regardless of how the bands were distributed.
+ */
 template <int N>
-double estimateSDFErrorInner(const BitmapConstRef<float, N> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule) {
+class ErrorEstimator {
+
+public:
+    int firstRow, endRow;
+    std::vector<double> subRowErrors;
+
+    ErrorEstimator(const BitmapConstRef<float, N> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule, int threadCount) :
+        firstRow(0), endRow(0), subRowErrors((sdf.height-1)*scanlinesPerRow),
+        sdf(sdf), shape(shape), scale(scale), translate(translate), scanlinesPerRow(scanlinesPerRow), fillRule(fillRule), threads(threadCount, (ThreadState *) NULL) {
+        xFrom = .5/scale.x-translate.x;
+        xTo = (sdf.width-.5)/scale.x-translate.x;
+        overlapFactor = 1/(xTo-xFrom);
+    }
+
+    ~ErrorEstimator() {
+        for (typename std::vector<ThreadState *>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+            delete *thread;
+    }
+
+    int bandCount() const {
+        return (endRow-firstRow+ERROR_ESTIMATION_BAND_HEIGHT-1)/ERROR_ESTIMATION_BAND_HEIGHT;
+    }
+
+    void operator()(int band, int thread) {
+        if (!threads[thread])
+            threads[thread] = new ThreadState(shape);
+        ThreadState &state = *threads[thread];
+        double subRowSize = 1./scanlinesPerRow;
+        for (int row = firstRow+band*ERROR_ESTIMATION_BAND_HEIGHT, rowEnd = min(row+ERROR_ESTIMATION_BAND_HEIGHT, endRow); row < rowEnd; ++row) {
+            for (int subRow = 0; subRow < scanlinesPerRow; ++subRow) {
+                double bt = (subRow+.5)*subRowSize;
+                double y = (row+bt+.5)/scale.y-translate.y;
+                state.refScanlineGenerator.scanline(state.refScanline, y);
+                scanlineSDF(state.sdfScanline, state.intersections, sdf, scale, translate, shape.inverseYAxis, y);
+                subRowErrors[row*scanlinesPerRow+subRow] = 1-overlapFactor*Scanline::overlap(state.refScanline, state.sdfScanline, xFrom, xTo, fillRule);
+            }
+        }
+    }
+
+private:
+    struct ThreadState {
+        ScanlineGenerator refScanlineGenerator;
+        Scanline refScanline, sdfScanline;
+        std::vector<Scanline::Intersection> intersections;
+
+        explicit ThreadState(const Shape &shape) : refScanlineGenerator(shape) { }
+    };
+
+    BitmapConstRef<float, N> sdf;
+    const Shape &shape;
+    Vector2 scale, translate;
+    int scanlinesPerRow;
+    FillRule fillRule;
+    double xFrom, xTo, overlapFactor;
+    std::vector<ThreadState *> threads;
+
+};
+
+template <int N>
+double estimateSDFErrorInner(const BitmapConstRef<float, N> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule, double errorLimit, Executor *executor) {
     if (sdf.width <= 1 || sdf.height <= 1 || scanlinesPerRow < 1)
         return 0;
-    double subRowSize = 1./scanlinesPerRow;
-    double xFrom = .5/scale.x-translate.x;
-    double xTo = (sdf.width-.5)/scale.x-translate.x;
-    double overlapFactor = 1/(xTo-xFrom);
+    Executor &resolvedExecutor = resolveExecutor(executor);
+    ErrorEstimator<N> estimator(sdf, shape, scale, translate, scanlinesPerRow, fillRule, resolvedExecutor.threadCount());
     double error = 0;
-    Scanline refScanline, sdfScanline;
-    for (int row = 0; row < sdf.height-1; ++row) {
-        for (int subRow = 0; subRow < scanlinesPerRow; ++subRow) {
-            double bt = (subRow+.5)*subRowSize;
-            double y = (row+bt+.5)/scale.y-translate.y;
-            shape.scanline(refScanline, y);
-            scanlineSDF(sdfScanline, sdf, scale, translate, shape.inverseYAxis, y);
-            error += 1-overlapFactor*Scanline::overlap(refScanline, sdfScanline, xFrom, xTo, fillRule);
-        }
+    double errorScale = 1./((sdf.height-1)*scanlinesPerRow);
+    // With an error limit, the rows are processed in rounds of ERROR_ESTIMATION_ROUND_HEIGHT, after which the error accumulated so far, which cannot decrease, is compared to the limit
+    int roundHeight = errorLimit > 0 ? ERROR_ESTIMATION_ROUND_HEIGHT : sdf.height-1;
+    for (estimator.firstRow = 0; estimator.firstRow < sdf.height-1; estimator.firstRow = estimator.endRow) {
+        estimator.endRow = min(estimator.firstRow+roundHeight, sdf.height-1);
+        parallelFor(&resolvedExecutor, estimator.bandCount(), estimator);
+        for (int i = estimator.firstRow*scanlinesPerRow; i < estimator.endRow*scanlinesPerRow; ++i)
+            error += estimator.subRowErrors[i];
+        if (errorLimit > 0 && error*errorScale > errorLimit)
+            break;
     }
-    return error/((sdf.height-1)*scanlinesPerRow);
+    return error*errorScale;
 }
 
-double estimateSDFError(const BitmapConstRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule) {
-    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule);
+double estimateSDFError(const BitmapConstRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule, double errorLimit, Executor *executor) {
+    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule, errorLimit, executor);
 }
-double estimateSDFError(const BitmapConstRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule) {
-    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule);
+double estimateSDFError(const BitmapConstRef<float, 3> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule, double errorLimit, Executor *executor) {
+    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule, errorLimit, executor);
 }
-double estimateSDFError(const BitmapConstRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule) {
-    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule);
+double estimateSDFError(const BitmapConstRef<float, 4> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int scanlinesPerRow, FillRule fillRule, double errorLimit, Executor *executor) {
+    return estimateSDFErrorInner(sdf, shape, scale, translate, scanlinesPerRow, fillRule, errorLimit, executor);
 }
 
 }
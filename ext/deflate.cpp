@@ -0,0 +1,457 @@
+
+#include "deflate.h"
+
+#include <algorithm>
+#include <lodepng.h>
+
+// The maximum distance of a match
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+// Matches of the minimum length farther than this take more bits than the literals they replace
+#define DEFLATE_TOO_FAR 4096
+#define DEFLATE_HASH_BITS 15
+// The number of symbols after which a block is ended
+#define DEFLATE_BLOCK_SYMBOLS 32768
+#define DEFLATE_MAX_STORED_LENGTH 65535
+
+namespace msdfgen {
+
+static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const int lengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const int distanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+/// The order in which the lengths of the code length codes are stored.
+static const int codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+/// The parameters of the match search of a compression level.
+struct DeflateLevel {
+    /// The maximum number of earlier positions with the same hash compared with the current one.
+    int chainLength;
+    /// If a match of at least this length has already been found at the previous position, only a quarter of the chain is searched.
+    int goodLength;
+    /// A match of at least this length is taken without comparing further positions.
+    int niceLength;
+    /// If positive, a match shorter than this is deferred by one position in case a longer one starts there (lazy matching).
+    int lazyLength;
+    /// Without lazy matching, only the positions inside matches up to this length are hashed.
+    int insertLength;
+};
+
+// The same parameters as zlib's
+static const DeflateLevel deflateLevels[10] = {
+    { 0, 0, 0, 0, 0 },
+    { 4, 4, 8, 0, 4 },
+    { 8, 4, 16, 0, 5 },
+    { 32, 4, 32, 0, 6 },
+    { 16, 4, 16, 4, 0 },
+    { 32, 8, 32, 16, 0 },
+    { 128, 8, 128, 16, 0 },
+    { 256, 8, 128, 32, 0 },
+    { 1024, 32, 258, 128, 0 },
+    { 4096, 32, 258, 258, 0 }
+};
+
+static int lengthSymbol(int length) {
+    return int(std::upper_bound(lengthBase, lengthBase+29, length)-lengthBase)-1;
+}
+
+static int distanceSymbol(int distance) {
+    return int(std::upper_bound(distanceBase, distanceBase+30, distance)-distanceBase)-1;
+}
+
+static unsigned fixedLiteralLength(int symbol) {
+    return symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+}
+
+/// Computes the canonical Huffman codes of the code lengths, with their bits reversed to be written from the least significant one.
+static void makeCodes(unsigned *codes, const unsigned *lengths, int count) {
+    unsigned lengthCounts[16] = { }, nextCode[16] = { };
+    for (int i = 0; i < count; ++i)
+        ++lengthCounts[lengths[i]];
+    lengthCounts[0] = 0;
+    for (int bits = 1, code = 0; bits < 16; ++bits)
+        nextCode[bits] = code = (code+lengthCounts[bits-1])<<1;
+    for (int i = 0; i < count; ++i) {
+        unsigned code = lengths[i] ? nextCode[lengths[i]]++ : 0, reversed = 0;
+        for (unsigned bit = 0; bit < lengths[i]; ++bit)
+            reversed |= (code>>bit&1u)<<(lengths[i]-bit-1);
+        codes[i] = reversed;
+    }
+}
+
+/// Appends bits to a byte vector starting with the least significant bit of each byte.
+class BitWriter {
+
+public:
+    explicit BitWriter(std::vector<byte> &output) : output(output), buffer(0), bitCount(0) { }
+
+    /// Writes the count (up to 16) lowest bits of value.
+    void write(unsigned value, int count) {
+        buffer |= value<<bitCount;
+        for (bitCount += count; bitCount >= 8; bitCount -= 8) {
+            output.push_back(byte(buffer));
+            buffer >>= 8;
+        }
+    }
+
+    bool aligned() const {
+        return !bitCount;
+    }
+
+    /// Pads the current byte with zero bits.
+    void align() {
+        if (bitCount)
+            write(0, 8-bitCount);
+    }
+
+    /// Writes whole bytes, which must start at a byte boundary.
+    void writeBytes(const byte *data, size_t length) {
+        output.insert(output.end(), data, data+length);
+    }
+
+private:
+    std::vector<byte> &output;
+    unsigned buffer;
+    int bitCount;
+
+};
+
+/// A literal byte if distance is zero, or a match of the bytes at the distance back otherwise.
+struct DeflateSymbol {
+    unsigned short value;
+    unsigned short distance;
+};
+
+/// Performs the LZ77 match search with hash chains and encodes the resulting symbols into blocks of the smallest type.
+class DeflateEncoder {
+
+public:
+    DeflateEncoder(std::vector<byte> &output, const byte *data, int compressionLevel) : writer(output), data(data), level(deflateLevels[std::min(std::max(compressionLevel, 0), 9)]), head(size_t(1)<<DEFLATE_HASH_BITS, 0), prev(DEFLATE_WINDOW_SIZE, 0), blockStart(0), covered(0) { }
+
+    void compress(size_t start, size_t end, bool final) {
+        blockStart = covered = start;
+        if (!level.chainLength) {
+            covered = end;
+            writeStored(final);
+        } else {
+            symbols.reserve(DEFLATE_BLOCK_SYMBOLS);
+            for (size_t pos = start > DEFLATE_WINDOW_SIZE ? start-DEFLATE_WINDOW_SIZE : 0; pos < start; ++pos)
+                insert(pos, end);
+            if (level.lazyLength > 0)
+                matchLazy(start, end);
+            else
+                matchGreedy(start, end);
+            flushBlock(final);
+        }
+        // Unless the stream ends here, an empty stored block aligns the end of the blocks to a byte boundary
+        if (!final && !writer.aligned()) {
+            static const byte emptyLength[4] = { 0x00, 0x00, 0xff, 0xff };
+            writer.write(0, 3);
+            writer.align();
+            writer.writeBytes(emptyLength, sizeof(emptyLength));
+        }
+        writer.align();
+    }
+
+private:
+    BitWriter writer;
+    const byte *data;
+    DeflateLevel level;
+    /// The latest position plus one with each hash, and the previous one with the same hash as each position in the window.
+    std::vector<size_t> head, prev;
+    std::vector<DeflateSymbol> symbols;
+    /// The positions of the first byte of the current block and the first byte not yet covered by symbols.
+    size_t blockStart, covered;
+
+    size_t hash(size_t pos) const {
+        return ((data[pos]|data[pos+1]<<8|data[pos+2]<<16)*2654435761u&0xffffffffu)>>(32-DEFLATE_HASH_BITS);
+    }
+
+    void insert(size_t pos, size_t end) {
+        if (pos+DEFLATE_MIN_MATCH <= end) {
+            size_t &latest = head[hash(pos)];
+            prev[pos&(DEFLATE_WINDOW_SIZE-1)] = latest;
+            latest = pos+1;
+        }
+    }
+
+    /// Returns the length of the longest match at pos longer than minLength, or zero if there is none, and sets its distance.
+    int findMatch(int &distance, size_t pos, size_t end, int minLength) const {
+        int maxLength = int(std::min(end-pos, size_t(DEFLATE_MAX_MATCH)));
+        int bestLength = std::max(minLength, DEFLATE_MIN_MATCH-1);
+        if (maxLength <= bestLength)
+            return 0;
+        const byte *current = data+pos;
+        size_t limit = pos > DEFLATE_WINDOW_SIZE ? pos-DEFLATE_WINDOW_SIZE : 0;
+        size_t next = head[hash(pos)];
+        bool found = false;
+        for (int chain = minLength >= level.goodLength ? level.chainLength>>2 : level.chainLength; next > limit && chain > 0; --chain) {
+            size_t candidate = next-1;
+            const byte *match = data+candidate;
+            if (match[bestLength] == current[bestLength] && match[0] == current[0]) {
+                int length = 1;
+                while (length < maxLength && match[length] == current[length])
+                    ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    distance = int(pos-candidate);
+                    found = true;
+                    if (length >= level.niceLength || length == maxLength)
+                        break;
+                }
+            }
+            // Positions older than the window may have been overwritten by newer ones
+            size_t older = prev[candidate&(DEFLATE_WINDOW_SIZE-1)];
+            if (older >= next)
+                break;
+            next = older;
+        }
+        if (!found || (bestLength == DEFLATE_MIN_MATCH && distance > DEFLATE_TOO_FAR))
+            return 0;
+        return bestLength;
+    }
+
+    void matchGreedy(size_t start, size_t end) {
+        for (size_t pos = start; pos < end;) {
+            int distance = 0;
+            int length = findMatch(distance, pos, end, 0);
+            insert(pos, end);
+            if (length) {
+                emitMatch(length, distance);
+                if (length <= level.insertLength) {
+                    for (size_t matchEnd = pos+length; ++pos < matchEnd;)
+                        insert(pos, end);
+                } else
+                    pos += length;
+            } else
+                emitLiteral(data[pos++]);
+        }
+    }
+
+    void matchLazy(size_t start, size_t end) {
+        // A match found at the previous position, which is emitted unless there is a longer one at the current position
+        int prevLength = 0, prevDistance = 0;
+        bool pending = false;
+        for (size_t pos = start; pos < end;) {
+            int distance = 0;
+            int length = prevLength < level.lazyLength ? findMatch(distance, pos, end, prevLength) : 0;
+            insert(pos, end);
+            if (pending && prevLength && !length) {
+                emitMatch(prevLength, prevDistance);
+                for (size_t matchEnd = pos-1+prevLength; ++pos < matchEnd;)
+                    insert(pos, end);
+                pending = false;
+                prevLength = 0;
+                continue;
+            }
+            if (pending)
+                emitLiteral(data[pos-1]);
+            if (length >= level.niceLength) {
+                emitMatch(length, distance);
+                for (size_t matchEnd = pos+length; ++pos < matchEnd;)
+                    insert(pos, end);
+                pending = false;
+                prevLength = 0;
+                continue;
+            }
+            pending = true;
+            prevLength = length;
+            prevDistance = distance;
+            ++pos;
+        }
+        if (pending) {
+            if (prevLength)
+                emitMatch(prevLength, prevDistance);
+            else
+                emitLiteral(data[end-1]);
+        }
+    }
+
+    void emitLiteral(byte value) {
+        DeflateSymbol symbol = { value, 0 };
+        symbols.push_back(symbol);
+        ++covered;
+        if (symbols.size() >= DEFLATE_BLOCK_SYMBOLS)
+            flushBlock(false);
+    }
+
+    void emitMatch(int length, int distance) {
+        DeflateSymbol symbol = { (unsigned short) length, (unsigned short) distance };
+        symbols.push_back(symbol);
+        covered += length;
+        if (symbols.size() >= DEFLATE_BLOCK_SYMBOLS)
+            flushBlock(false);
+    }
+
+    /// Writes the symbols collected so far as a block of whichever type is the smallest.
+    void flushBlock(bool final) {
+        if (symbols.empty() && !final)
+            return;
+        unsigned literalFrequencies[286] = { }, distanceFrequencies[30] = { };
+        size_t extraBits = 0;
+        for (std::vector<DeflateSymbol>::const_iterator symbol = symbols.begin(); symbol != symbols.end(); ++symbol) {
+            if (symbol->distance) {
+                int lengthCode = lengthSymbol(symbol->value), distanceCode = distanceSymbol(symbol->distance);
+                ++literalFrequencies[257+lengthCode];
+                ++distanceFrequencies[distanceCode];
+                extraBits += lengthExtraBits[lengthCode]+distanceExtraBits[distanceCode];
+            } else
+                ++literalFrequencies[symbol->value];
+        }
+        literalFrequencies[256] = 1;
+
+        // Dynamic Huffman codes, whose lengths are run-length encoded with codes 16 (repeat previous 3-6 times), 17 (3-10 zeros) and 18 (11-138 zeros)
+        // The fixed codes also assign lengths to the unused symbols 286 and 287, which affects the codes of the other symbols
+        unsigned literalLengths[288] = { }, distanceLengths[30];
+        lodepng_huffman_code_lengths(literalLengths, literalFrequencies, 286, 15);
+        lodepng_huffman_code_lengths(distanceLengths, distanceFrequencies, 30, 15);
+        int literalCount = 286, distanceCount = 30;
+        while (literalCount > 257 && !literalLengths[literalCount-1])
+            --literalCount;
+        while (distanceCount > 1 && !distanceLengths[distanceCount-1])
+            --distanceCount;
+        std::vector<unsigned> lengths(literalLengths, literalLengths+literalCount);
+        lengths.insert(lengths.end(), distanceLengths, distanceLengths+distanceCount);
+        // The repeat codes are followed by their extra bits in lengthSymbols
+        std::vector<unsigned> lengthSymbols;
+        for (size_t i = 0; i < lengths.size();) {
+            size_t run = 1;
+            while (i+run < lengths.size() && lengths[i+run] == lengths[i])
+                ++run;
+            if (!lengths[i] && run >= 3) {
+                run = std::min(run, size_t(138));
+                lengthSymbols.push_back(run >= 11 ? 18 : 17);
+                lengthSymbols.push_back(unsigned(run >= 11 ? run-11 : run-3));
+                i += run;
+            } else {
+                lengthSymbols.push_back(lengths[i]);
+                for (++i, --run; lengths[i-1] && run >= 3;) {
+                    size_t repeat = std::min(run, size_t(6));
+                    lengthSymbols.push_back(16);
+                    lengthSymbols.push_back(unsigned(repeat-3));
+                    i += repeat, run -= repeat;
+                }
+            }
+        }
+        unsigned lengthFrequencies[19] = { };
+        for (size_t i = 0; i < lengthSymbols.size(); ++i)
+            if (++lengthFrequencies[lengthSymbols[i]], lengthSymbols[i] >= 16)
+                ++i;
+        unsigned lengthLengths[19];
+        lodepng_huffman_code_lengths(lengthLengths, lengthFrequencies, 19, 7);
+        int lengthLengthCount = 19;
+        while (lengthLengthCount > 4 && !lengthLengths[codeLengthOrder[lengthLengthCount-1]])
+            --lengthLengthCount;
+
+        size_t dynamicSize = 3+14+3*lengthLengthCount+extraBits, fixedSize = 3+extraBits;
+        for (size_t i = 0; i < lengthSymbols.size(); ++i) {
+            unsigned symbol = lengthSymbols[i];
+            dynamicSize += lengthLengths[symbol];
+            if (symbol >= 16)
+                dynamicSize += symbol == 16 ? 2 : symbol == 17 ? 3 : 7, ++i;
+        }
+        for (int i = 0; i < 286; ++i) {
+            dynamicSize += literalFrequencies[i]*literalLengths[i];
+            fixedSize += literalFrequencies[i]*fixedLiteralLength(i);
+        }
+        for (int i = 0; i < 30; ++i) {
+            dynamicSize += distanceFrequencies[i]*distanceLengths[i];
+            fixedSize += distanceFrequencies[i]*5;
+        }
+        size_t storedLength = covered-blockStart;
+        size_t storedSize = 8*storedLength+(storedLength/DEFLATE_MAX_STORED_LENGTH+1)*(3+7+32);
+
+        if (storedSize <= fixedSize && storedSize <= dynamicSize)
+            writeStored(final);
+        else if (fixedSize <= dynamicSize) {
+            for (int i = 0; i < 288; ++i)
+                literalLengths[i] = fixedLiteralLength(i);
+            for (int i = 0; i < 30; ++i)
+                distanceLengths[i] = 5;
+            writer.write(final, 1);
+            writer.write(1, 2);
+            writeSymbols(literalLengths, distanceLengths);
+        } else {
+            unsigned lengthCodes[19];
+            makeCodes(lengthCodes, lengthLengths, 19);
+            writer.write(final, 1);
+            writer.write(2, 2);
+            writer.write(literalCount-257, 5);
+            writer.write(distanceCount-1, 5);
+            writer.write(lengthLengthCount-4, 4);
+            for (int i = 0; i < lengthLengthCount; ++i)
+                writer.write(lengthLengths[codeLengthOrder[i]], 3);
+            for (size_t i = 0; i < lengthSymbols.size(); ++i) {
+                unsigned symbol = lengthSymbols[i];
+                writer.write(lengthCodes[symbol], lengthLengths[symbol]);
+                if (symbol >= 16)
+                    writer.write(lengthSymbols[++i], symbol == 16 ? 2 : symbol == 17 ? 3 : 7);
+            }
+            writeSymbols(literalLengths, distanceLengths);
+        }
+        symbols.clear();
+        blockStart = covered;
+    }
+
+    void writeSymbols(const unsigned *literalLengths, const unsigned *distanceLengths) {
+        unsigned literalCodes[288], distanceCodes[30];
+        makeCodes(literalCodes, literalLengths, 288);
+        makeCodes(distanceCodes, distanceLengths, 30);
+        for (std::vector<DeflateSymbol>::const_iterator symbol = symbols.begin(); symbol != symbols.end(); ++symbol) {
+            if (symbol->distance) {
+                int lengthCode = lengthSymbol(symbol->value), distanceCode = distanceSymbol(symbol->distance);
+                writer.write(literalCodes[257+lengthCode], literalLengths[257+lengthCode]);
+                writer.write(symbol->value-lengthBase[lengthCode], lengthExtraBits[lengthCode]);
+                writer.write(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+                writer.write(symbol->distance-distanceBase[distanceCode], distanceExtraBits[distanceCode]);
+            } else
+                writer.write(literalCodes[symbol->value], literalLengths[symbol->value]);
+        }
+        writer.write(literalCodes[256], literalLengths[256]);
+    }
+
+    /// Writes the bytes of the current block uncompressed, split into as many stored blocks as needed.
+    void writeStored(bool final) {
+        size_t pos = blockStart;
+        do {
+            size_t length = std::min(covered-pos, size_t(DEFLATE_MAX_STORED_LENGTH));
+            byte header[4] = { byte(length), byte(length>>8), byte(~length), byte(~length>>8) };
+            writer.write(final && pos+length == covered, 1);
+            writer.write(0, 2);
+            writer.align();
+            writer.writeBytes(header, sizeof(header));
+            writer.writeBytes(data+pos, length);
+            pos += length;
+        } while (pos < covered);
+        blockStart = covered;
+    }
+
+};
+
+void deflateBlocks(std::vector<byte> &output, const byte *data, size_t start, size_t end, int compressionLevel, bool final) {
+    DeflateEncoder encoder(output, data, compressionLevel);
+    encoder.compress(start, end, final);
+}
+
+unsigned adler32(unsigned adler, const byte *data, size_t length) {
+    unsigned a = adler&0xffff, b = adler>>16;
+    while (length) {
+        // The largest number of bytes before b may overflow
+        size_t n = std::min(length, size_t(5552));
+        length -= n;
+        while (n--)
+            b += a += *data++;
+        a %= 65521, b %= 65521;
+    }
+    return b<<16|a;
+}
+
+unsigned combineAdler32(unsigned adler1, unsigned adler2, size_t length2) {
+    unsigned long long remainder = length2%65521;
+    unsigned long long a = (adler1&0xffff)+(adler2&0xffff)+65521-1;
+    unsigned long long b = remainder*(adler1&0xffff)%65521+(adler1>>16)+(adler2>>16)+65521-remainder;
+    return unsigned(b%65521)<<16|unsigned(a%65521);
+}
+
+}
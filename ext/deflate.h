@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+#include "../core/BitmapRef.hpp"
+
+namespace msdfgen {
+
+/// Compresses the bytes from data[start] to data[end-1] into raw deflate blocks (RFC 1951) appended to output, with compressionLevel from 0 (stored without compression) and 1 (fastest) to 9 (smallest output).
+/// Up to 32 KiB of the bytes preceding start may be referenced, so they must precede the blocks in the same stream. Unless final is set, the blocks end with an empty stored block, which aligns them to a byte boundary, so that other blocks may be appended.
+void deflateBlocks(std::vector<byte> &output, const byte *data, size_t start, size_t end, int compressionLevel, bool final);
+
+/// Continues the Adler-32 checksum adler, which is 1 at the start of a stream, with the bytes data[0] to data[length-1].
+unsigned adler32(unsigned adler, const byte *data, size_t length);
+
+/// Returns the Adler-32 checksum of two consecutive sequences of bytes, given the checksums of each and the length of the second one.
+unsigned combineAdler32(unsigned adler1, unsigned adler2, size_t length2);
+
+}
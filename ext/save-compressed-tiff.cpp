@@ -0,0 +1,330 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "save-compressed-tiff.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "../core/arithmetics.hpp"
+#include "deflate.h"
+
+// The approximate number of uncompressed bytes of each strip
+#define TIFF_STRIP_SIZE 262144
+#define TIFF_LZW_CLEAR 256
+#define TIFF_LZW_END 257
+#define TIFF_LZW_FIRST 258
+// The table of codes is reset when the next code would reach this value
+#define TIFF_LZW_LIMIT 4094
+#define TIFF_LZW_HASH_BITS 13
+
+namespace msdfgen {
+
+enum TiffFieldType {
+    TIFF_SHORT = 3,
+    TIFF_LONG = 4,
+    TIFF_RATIONAL = 5,
+    TIFF_FLOAT = 11
+};
+
+/// Assembles an image file directory in memory. The entries must be added in the order of their tags. Values which do not fit into an entry are placed after the directory.
+class TiffDirectory {
+
+public:
+    /// Adds an entry with count values, which are stored in valueCount elements of values (twice as many for rationals).
+    template <typename T>
+    void add(int tag, TiffFieldType type, const T *values, int count, int valueCount) {
+        Entry entry = { (unsigned short) tag, (unsigned short) type, unsigned(count), std::vector<byte>((const byte *) values, (const byte *) (values+valueCount)) };
+        entries.push_back(entry);
+    }
+
+    template <typename T>
+    void add(int tag, TiffFieldType type, const T *values, int count) {
+        add(tag, type, values, count, count);
+    }
+
+    template <typename T>
+    void add(int tag, TiffFieldType type, T value) {
+        add(tag, type, &value, 1);
+    }
+
+    /// Appends the directory, which is located at offset in the file, to output.
+    void write(std::vector<byte> &output, unsigned offset) const {
+        unsigned valueOffset = offset+2+12*unsigned(entries.size())+4;
+        std::vector<byte> values;
+        append(output, (unsigned short) entries.size());
+        for (std::vector<Entry>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+            append(output, entry->tag);
+            append(output, entry->type);
+            append(output, entry->count);
+            if (entry->data.size() <= 4) {
+                output.insert(output.end(), entry->data.begin(), entry->data.end());
+                output.resize(output.size()+4-entry->data.size());
+            } else {
+                append(output, unsigned(valueOffset+values.size()));
+                values.insert(values.end(), entry->data.begin(), entry->data.end());
+                values.resize((values.size()+1)&~size_t(1));
+            }
+        }
+        // Offset of next directory
+        append(output, 0u);
+        output.insert(output.end(), values.begin(), values.end());
+    }
+
+private:
+    struct Entry {
+        unsigned short tag, type;
+        unsigned count;
+        std::vector<byte> data;
+    };
+
+    std::vector<Entry> entries;
+
+    template <typename T>
+    static void append(std::vector<byte> &output, T value) {
+        output.insert(output.end(), (const byte *) &value, (const byte *) (&value+1));
+    }
+
+};
+
+/// Compresses bytes with the LZW variant of TIFF, which writes codes from the most significant bit and widens them one code earlier than needed.
+class TiffLzwEncoder {
+
+public:
+    explicit TiffLzwEncoder(std::vector<byte> &output) : output(output), buffer(0), bitCount(0), codeBits(9), nextCode(TIFF_LZW_FIRST), keys(size_t(1)<<TIFF_LZW_HASH_BITS), codes(size_t(1)<<TIFF_LZW_HASH_BITS) { }
+
+    void encode(const byte *data, size_t length) {
+        writeCode(TIFF_LZW_CLEAR);
+        if (length) {
+            // The code of the longest sequence in the table that the remaining data start with
+            unsigned prefix = data[0];
+            for (size_t i = 1; i < length; ++i) {
+                unsigned key = (prefix<<8|data[i])+1;
+                size_t slot = (key*2654435761u&0xffffffffu)>>(32-TIFF_LZW_HASH_BITS);
+                while (keys[slot] && keys[slot] != key)
+                    slot = (slot+1)&((size_t(1)<<TIFF_LZW_HASH_BITS)-1);
+                if (keys[slot]) {
+                    prefix = codes[slot];
+                    continue;
+                }
+                writeCode(prefix);
+                keys[slot] = key;
+                codes[slot] = (unsigned short) nextCode;
+                addCode();
+                prefix = data[i];
+            }
+            writeCode(prefix);
+            addCode();
+        }
+        writeCode(TIFF_LZW_END);
+        if (bitCount)
+            output.push_back(byte(buffer<<(8-bitCount)));
+    }
+
+private:
+    std::vector<byte> &output;
+    unsigned buffer;
+    int bitCount, codeBits;
+    unsigned nextCode;
+    /// A hash table of the sequences in the table, whose keys are the code of the sequence without its last byte and the byte, plus one to distinguish empty slots.
+    std::vector<unsigned> keys;
+    std::vector<unsigned short> codes;
+
+    void writeCode(unsigned code) {
+        buffer = buffer<<codeBits|code;
+        for (bitCount += codeBits; bitCount >= 8; bitCount -= 8)
+            output.push_back(byte(buffer>>(bitCount-8)));
+    }
+
+    /// Advances to the next code after a sequence has been added to the table, which is reset once full.
+    void addCode() {
+        if (++nextCode == TIFF_LZW_LIMIT) {
+            writeCode(TIFF_LZW_CLEAR);
+            std::fill(keys.begin(), keys.end(), 0u);
+            nextCode = TIFF_LZW_FIRST;
+            codeBits = 9;
+        } else if (nextCode > (1u<<codeBits)-1)
+            ++codeBits;
+    }
+
+};
+
+/// Applies the floating-point predictor (TIFF Technical Note 3) to a row of count values of pixels with N channels.
+template <int N>
+static void predictFloatRow(byte *output, const float *values, int count) {
+    for (int i = 0; i < count; ++i) {
+        unsigned bits;
+        memcpy(&bits, values+i, sizeof(bits));
+        for (int b = 0; b < 4; ++b)
+            output[b*count+i] = byte(bits>>(24-8*b));
+    }
+    for (int i = 4*count-1; i >= N; --i)
+        output[i] = byte(output[i]-output[i-N]);
+}
+
+/**
+ * Encodes the strips or tiles of a TIFF image in parallel, reading the rows directly from the bitmap, and writes them followed by the image file directory.
+ * Tiles at the right and bottom edges are padded with zeros to their full size, and the strips only depend on the image dimensions.
+ */
+template <int N>
+class TiffSegmentEncoder {
+
+public:
+    TiffSegmentEncoder(const BitmapConstRef<float, N> &bitmap, const TiffEncoderConfig &config) :
+        topDown(bitmap.flipped()), config(config),
+        segmentWidth(config.tileSize > 0 ? config.tileSize : bitmap.width),
+        segmentHeight(config.tileSize > 0 ? config.tileSize : max(TIFF_STRIP_SIZE/int(sizeof(float)*N*bitmap.width), 1)),
+        columns((bitmap.width+segmentWidth-1)/segmentWidth), rows((bitmap.height+segmentHeight-1)/segmentHeight),
+        segments(columns*rows) { }
+
+    int segmentCount() const {
+        return columns*rows;
+    }
+
+    void operator()(int index, int) {
+        int x0 = index%columns*segmentWidth, y0 = index/columns*segmentHeight;
+        int height = config.tileSize > 0 ? segmentHeight : min(segmentHeight, topDown.height-y0);
+        int count = N*segmentWidth, copied = N*min(segmentWidth, topDown.width-x0);
+        std::vector<float> row(count);
+        std::vector<byte> raw(sizeof(float)*count*height);
+        for (int y = 0; y < height && y0+y < topDown.height; ++y) {
+            memcpy(&row[0], topDown(x0, y0+y), sizeof(float)*copied);
+            byte *output = &raw[sizeof(float)*count*y];
+            if (predictor())
+                predictFloatRow<N>(output, &row[0], count);
+            else
+                memcpy(output, &row[0], sizeof(float)*count);
+        }
+        std::vector<byte> &segment = segments[index];
+        switch (config.compression) {
+            case TIFF_COMPRESSION_LZW:
+                TiffLzwEncoder(segment).encode(&raw[0], raw.size());
+                break;
+            case TIFF_COMPRESSION_DEFLATE: {
+                int level = max(config.compressionLevel, 1);
+                int levelFlags = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+                segment.push_back(0x78);
+                segment.push_back(byte(levelFlags<<6|(31-(0x7800|levelFlags<<6)%31)));
+                deflateBlocks(segment, &raw[0], 0, raw.size(), level, true);
+                unsigned adler = adler32(1, &raw[0], raw.size());
+                for (int i = 24; i >= 0; i -= 8)
+                    segment.push_back(byte(adler>>i));
+                break;
+            }
+            default:
+                segment.swap(raw);
+        }
+    }
+
+    bool write(const char *filename) const {
+        // The encoded segments follow the 8-byte header, and the directory starts at the next even offset
+        std::vector<unsigned> offsets(segments.size()), byteCounts(segments.size());
+        unsigned long long dataEnd = 8;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            offsets[i] = unsigned(dataEnd);
+            byteCounts[i] = unsigned(segments[i].size());
+            dataEnd += segments[i].size();
+        }
+        unsigned long long end = dataEnd+(dataEnd&1);
+        if (end > 0xffff0000ull)
+            return false;
+
+        static const unsigned short compressionCodes[] = { 1, 5, 8 };
+        unsigned short bitsPerSample[N], sampleFormat[N];
+        float minSampleValue[N], maxSampleValue[N];
+        for (int i = 0; i < N; ++i) {
+            bitsPerSample[i] = 32, sampleFormat[i] = 3;
+            minSampleValue[i] = 0.f, maxSampleValue[i] = 1.f;
+        }
+        unsigned resolution[2] = { 300, 1 };
+        bool tiled = config.tileSize > 0;
+        TiffDirectory directory;
+        directory.add(0x0100, TIFF_LONG, unsigned(topDown.width)); // ImageWidth
+        directory.add(0x0101, TIFF_LONG, unsigned(topDown.height)); // ImageLength
+        directory.add(0x0102, TIFF_SHORT, bitsPerSample, N); // BitsPerSample
+        directory.add(0x0103, TIFF_SHORT, compressionCodes[config.compression]); // Compression
+        directory.add(0x0106, TIFF_SHORT, (unsigned short) (N >= 3 ? 2 : 1)); // PhotometricInterpretation
+        if (!tiled)
+            directory.add(0x0111, TIFF_LONG, &offsets[0], int(offsets.size())); // StripOffsets
+        directory.add(0x0115, TIFF_SHORT, (unsigned short) N); // SamplesPerPixel
+        if (!tiled) {
+            directory.add(0x0116, TIFF_LONG, unsigned(segmentHeight)); // RowsPerStrip
+            directory.add(0x0117, TIFF_LONG, &byteCounts[0], int(byteCounts.size())); // StripByteCounts
+        }
+        directory.add(0x011a, TIFF_RATIONAL, resolution, 1, 2); // XResolution
+        directory.add(0x011b, TIFF_RATIONAL, resolution, 1, 2); // YResolution
+        directory.add(0x0128, TIFF_SHORT, (unsigned short) 2); // ResolutionUnit
+        if (predictor())
+            directory.add(0x013d, TIFF_SHORT, (unsigned short) 3); // Predictor
+        if (tiled) {
+            directory.add(0x0142, TIFF_LONG, unsigned(segmentWidth)); // TileWidth
+            directory.add(0x0143, TIFF_LONG, unsigned(segmentHeight)); // TileLength
+            directory.add(0x0144, TIFF_LONG, &offsets[0], int(offsets.size())); // TileOffsets
+            directory.add(0x0145, TIFF_LONG, &byteCounts[0], int(byteCounts.size())); // TileByteCounts
+        }
+        if (N == 4)
+            directory.add(0x0152, TIFF_SHORT, (unsigned short) 2); // ExtraSamples (unassociated alpha)
+        directory.add(0x0153, TIFF_SHORT, sampleFormat, N); // SampleFormat
+        directory.add(0x0154, TIFF_FLOAT, minSampleValue, N); // SMinSampleValue
+        directory.add(0x0155, TIFF_FLOAT, maxSampleValue, N); // SMaxSampleValue
+        std::vector<byte> directoryBytes;
+        directory.write(directoryBytes, unsigned(end));
+
+        FILE *file = fopen(filename, "wb");
+        if (!file)
+            return false;
+        #ifdef __BIG_ENDIAN__
+            static const char byteOrder[] = "MM";
+        #else
+            static const char byteOrder[] = "II";
+        #endif
+        unsigned short magic = 42;
+        unsigned directoryOffset = unsigned(end);
+        fwrite(byteOrder, 1, 2, file);
+        fwrite(&magic, sizeof(magic), 1, file);
+        fwrite(&directoryOffset, sizeof(directoryOffset), 1, file);
+        for (size_t i = 0; i < segments.size(); ++i)
+            if (!segments[i].empty())
+                fwrite(&segments[i][0], 1, segments[i].size(), file);
+        if (end > dataEnd)
+            fputc(0, file);
+        fwrite(&directoryBytes[0], 1, directoryBytes.size(), file);
+        bool success = !ferror(file);
+        return !fclose(file) && success;
+    }
+
+private:
+    BitmapConstRef<float, N> topDown;
+    const TiffEncoderConfig &config;
+    int segmentWidth, segmentHeight, columns, rows;
+    std::vector<std::vector<byte> > segments;
+
+    bool predictor() const {
+        return config.floatingPointPredictor && config.compression != TIFF_COMPRESSION_NONE;
+    }
+
+};
+
+template <int N>
+static bool saveEncodedTiff(const BitmapConstRef<float, N> &bitmap, const char *filename, const TiffEncoderConfig &config) {
+    if (bitmap.width <= 0 || bitmap.height <= 0 || config.tileSize%16)
+        return false;
+    TiffSegmentEncoder<N> encoder(bitmap, config);
+    parallelFor(config.executor, encoder.segmentCount(), encoder);
+    return encoder.write(filename);
+}
+
+bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename, const TiffEncoderConfig &config) {
+    return saveEncodedTiff(bitmap, filename, config);
+}
+
+bool saveTiff(const BitmapConstRef<float, 3> &bitmap, const char *filename, const TiffEncoderConfig &config) {
+    return saveEncodedTiff(bitmap, filename, config);
+}
+
+bool saveTiff(const BitmapConstRef<float, 4> &bitmap, const char *filename, const TiffEncoderConfig &config) {
+    return saveEncodedTiff(bitmap, filename, config);
+}
+
+}
@@ -0,0 +1,36 @@
+
+#pragma once
+
+#include "../core/BitmapRef.hpp"
+#include "../core/Executor.h"
+
+namespace msdfgen {
+
+/// The compression of the strips or tiles of a TIFF file.
+enum TiffCompression {
+    TIFF_COMPRESSION_NONE,
+    TIFF_COMPRESSION_LZW,
+    TIFF_COMPRESSION_DEFLATE
+};
+
+/// The configuration of the TIFF encoder, which encodes the strips or tiles of an image in parallel.
+struct TiffEncoderConfig {
+    TiffCompression compression;
+    /// The level of Deflate compression, from 1 (fastest) to 9 (smallest file).
+    int compressionLevel;
+    /// Specifies whether to apply the floating-point predictor before compression, which stores the bytes of the values of each row in planes from the most significant one as differences from the previous pixel's.
+    bool floatingPointPredictor;
+    /// If positive, the image is divided into square tiles of this size, which must be a multiple of 16, instead of strips of rows, so that any region may be read without decoding the rest.
+    int tileSize;
+    /// An optional executor, such as a ThreadPool, which runs the encoding of the strips or tiles. The encoded file does not depend on the number of threads.
+    Executor *executor;
+
+    inline explicit TiffEncoderConfig(TiffCompression compression = TIFF_COMPRESSION_DEFLATE, int tileSize = 0) : compression(compression), compressionLevel(6), floatingPointPredictor(true), tileSize(tileSize), executor(NULL) { }
+};
+
+/// Saves the bitmap as a floating-point TIFF file, compressed and laid out as specified by config.
+bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename, const TiffEncoderConfig &config);
+bool saveTiff(const BitmapConstRef<float, 3> &bitmap, const char *filename, const TiffEncoderConfig &config);
+bool saveTiff(const BitmapConstRef<float, 4> &bitmap, const char *filename, const TiffEncoderConfig &config);
+
+}
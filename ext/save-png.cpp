@@ -3,63 +3,392 @@
 
 #include <cstring>
 #include <lodepng.h>
+#ifdef MSDFGEN_USE_LIBPNG
+    #include <png.h>
+#endif
+#include "../core/arithmetics.hpp"
 #include "../core/pixel-conversion.hpp"
+#include "deflate.h"
+
+// The approximate number of bytes of filtered rows compressed by each task of the built-in encoder
+#define PNG_BAND_SIZE 262144
+// The number of preceding bytes which deflate matches may reference
+#define PNG_DEFLATE_WINDOW 32768
 
 namespace msdfgen {
 
-bool savePng(const BitmapConstRef<byte, 1> &bitmap, const char *filename) {
-    std::vector<byte> pixels(bitmap.width*bitmap.height);
+/// Encodes the pixels directly if their rows are stored top-down without gaps, and from a flipped copy otherwise.
+template <int N>
+static bool saveBytePng(const BitmapConstRef<byte, N> &bitmap, const char *filename, LodePNGColorType colorType) {
+    BitmapConstRef<byte, N> topDown = bitmap.flipped();
+    if (topDown.contiguous())
+        return !lodepng::encode(filename, topDown.pixels, bitmap.width, bitmap.height, colorType);
+    std::vector<byte> pixels(N*bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
-        memcpy(&pixels[bitmap.width*y], bitmap(0, bitmap.height-y-1), bitmap.width);
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_GREY);
+        memcpy(&pixels[N*bitmap.width*y], topDown(0, y), N*bitmap.width);
+    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, colorType);
+}
+
+/// Passes the rows to a PngRowWriter from the top one down.
+template <int N>
+static bool saveFloatPng(const BitmapConstRef<float, N> &bitmap, const char *filename) {
+    PngRowWriter<N> writer;
+    if (!writer.open(filename, bitmap.width, bitmap.height))
+        return false;
+    for (int y = bitmap.height-1; y >= 0; --y)
+        if (!writer.writeRow(bitmap(0, y)))
+            break;
+    return writer.close();
+}
+
+bool savePng(const BitmapConstRef<byte, 1> &bitmap, const char *filename) {
+    return saveBytePng(bitmap, filename, LCT_GREY);
 }
 
 bool savePng(const BitmapConstRef<byte, 3> &bitmap, const char *filename) {
-    std::vector<byte> pixels(3*bitmap.width*bitmap.height);
-    for (int y = 0; y < bitmap.height; ++y)
-        memcpy(&pixels[3*bitmap.width*y], bitmap(0, bitmap.height-y-1), 3*bitmap.width);
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return saveBytePng(bitmap, filename, LCT_RGB);
 }
 
 bool savePng(const BitmapConstRef<byte, 4> &bitmap, const char *filename) {
-    std::vector<byte> pixels(4*bitmap.width*bitmap.height);
-    for (int y = 0; y < bitmap.height; ++y)
-        memcpy(&pixels[4*bitmap.width*y], bitmap(0, bitmap.height-y-1), 4*bitmap.width);
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+    return saveBytePng(bitmap, filename, LCT_RGBA);
 }
 
 bool savePng(const BitmapConstRef<float, 1> &bitmap, const char *filename) {
-    std::vector<byte> pixels(bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x)
-            *it++ = pixelFloatToByte(*bitmap(x, y));
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_GREY);
+    return saveFloatPng(bitmap, filename);
 }
 
 bool savePng(const BitmapConstRef<float, 3> &bitmap, const char *filename) {
-    std::vector<byte> pixels(3*bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x) {
-            *it++ = pixelFloatToByte(bitmap(x, y)[0]);
-            *it++ = pixelFloatToByte(bitmap(x, y)[1]);
-            *it++ = pixelFloatToByte(bitmap(x, y)[2]);
-        }
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return saveFloatPng(bitmap, filename);
 }
 
 bool savePng(const BitmapConstRef<float, 4> &bitmap, const char *filename) {
-    std::vector<byte> pixels(4*bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x) {
-            *it++ = pixelFloatToByte(bitmap(x, y)[0]);
-            *it++ = pixelFloatToByte(bitmap(x, y)[1]);
-            *it++ = pixelFloatToByte(bitmap(x, y)[2]);
-            *it++ = pixelFloatToByte(bitmap(x, y)[3]);
+    return saveFloatPng(bitmap, filename);
+}
+
+static void storeUint32(byte *dst, unsigned value) {
+    dst[0] = byte(value>>24), dst[1] = byte(value>>16), dst[2] = byte(value>>8), dst[3] = byte(value);
+}
+
+/// Completes a chunk whose data follow 4 bytes for its length and its 4-byte type in chunk by writing its length and appending its CRC.
+static void finishPngChunk(std::vector<byte> &chunk) {
+    storeUint32(&chunk[0], unsigned(chunk.size()-8));
+    unsigned crc = lodepng_crc32(&chunk[4], chunk.size()-4);
+    chunk.resize(chunk.size()+4);
+    storeUint32(&chunk[chunk.size()-4], crc);
+}
+
+static void startPngChunk(std::vector<byte> &chunk, const char *type) {
+    chunk.resize(8);
+    memcpy(&chunk[4], type, 4);
+}
+
+static int paethPredictor(int a, int b, int c) {
+    int pa = abs(b-c), pb = abs(a-c), pc = abs(a+b-2*c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+/// Writes the filter type and the filtered bytes of row, whose previous row is above, to output. The bytes to the left of the first pixel are zero.
+static void filterPngRow(byte *output, const byte *row, const byte *above, int length, int bpp, PngRowFilter filter) {
+    *output++ = byte(filter);
+    switch (filter) {
+        case PNG_ROW_FILTER_NONE:
+            memcpy(output, row, length);
+            break;
+        case PNG_ROW_FILTER_SUB:
+            for (int i = 0; i < length; ++i)
+                output[i] = byte(row[i]-(i >= bpp ? row[i-bpp] : 0));
+            break;
+        case PNG_ROW_FILTER_UP:
+            for (int i = 0; i < length; ++i)
+                output[i] = byte(row[i]-above[i]);
+            break;
+        case PNG_ROW_FILTER_AVERAGE:
+            for (int i = 0; i < length; ++i)
+                output[i] = byte(row[i]-(((i >= bpp ? row[i-bpp] : 0)+above[i])>>1));
+            break;
+        case PNG_ROW_FILTER_PAETH:
+            for (int i = 0; i < length; ++i)
+                output[i] = byte(row[i]-(i >= bpp ? paethPredictor(row[i-bpp], above[i], above[i-bpp]) : above[i]));
+            break;
+        default:;
+    }
+}
+
+/// Returns the sum of the filtered bytes of a row interpreted as signed, the heuristic by which the adaptive filter is chosen.
+static unsigned filteredPngRowCost(const byte *filtered, int length) {
+    unsigned cost = 0;
+    for (int i = 1; i <= length; ++i)
+        cost += filtered[i] < 128 ? filtered[i] : 256-filtered[i];
+    return cost;
+}
+
+static const byte *pngRowBytes(std::vector<byte> &, const BitmapConstRef<byte, 1> &topDown, int y) {
+    return topDown(0, y);
+}
+
+static const byte *pngRowBytes(std::vector<byte> &, const BitmapConstRef<byte, 3> &topDown, int y) {
+    return topDown(0, y);
+}
+
+static const byte *pngRowBytes(std::vector<byte> &, const BitmapConstRef<byte, 4> &topDown, int y) {
+    return topDown(0, y);
+}
+
+template <int N>
+static const byte *pngRowBytes(std::vector<byte> &buffer, const BitmapConstRef<float, N> &topDown, int y) {
+    const float *pixels = topDown(0, y);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = pixelFloatToByte(pixels[i]);
+    return &buffer[0];
+}
+
+/**
+ * Filters and compresses bands of about PNG_BAND_SIZE bytes of rows into separate IDAT chunks in parallel, reading the rows directly from the bitmap.
+ * The filtered rows preceding each band, up to the deflate window, are filtered again and serve as its dictionary, and all bands but the last end
+ * at a byte boundary, so the chunks form a single zlib stream. The bands only depend on the image dimensions, so the file does not depend on the threads.
+ */
+template <typename T, int N>
+class PngBandEncoder {
+
+public:
+    PngBandEncoder(const BitmapConstRef<T, N> &bitmap, const PngEncoderConfig &config) :
+        topDown(bitmap.flipped()), config(config), rowLength(N*bitmap.width+1), bandRows(max(PNG_BAND_SIZE/rowLength, 1)),
+        chunks(bandCount()), adlers(bandCount()) { }
+
+    int bandCount() const {
+        return (topDown.height+bandRows-1)/bandRows;
+    }
+
+    void operator()(int band, int) {
+        int y0 = band*bandRows, y1 = min(y0+bandRows, topDown.height);
+        int dictionaryRows = min(y0, (PNG_DEFLATE_WINDOW+rowLength-1)/rowLength);
+        int length = rowLength-1;
+        std::vector<byte> filtered((size_t) rowLength*(y1-y0+dictionaryRows));
+        std::vector<byte> rowBuffers[2], candidate(config.filter == PNG_ROW_FILTER_ADAPTIVE ? rowLength : 0);
+        rowBuffers[0].resize(length), rowBuffers[1].resize(length);
+        std::vector<byte> zeros(length);
+        const byte *above = y0-dictionaryRows > 0 ? pngRowBytes(rowBuffers[(y0-dictionaryRows-1)&1], topDown, y0-dictionaryRows-1) : &zeros[0];
+        byte *output = &filtered[0];
+        for (int y = y0-dictionaryRows; y < y1; ++y, output += rowLength) {
+            const byte *row = pngRowBytes(rowBuffers[y&1], topDown, y);
+            if (config.filter == PNG_ROW_FILTER_ADAPTIVE) {
+                unsigned bestCost = 0;
+                for (int type = PNG_ROW_FILTER_NONE; type < PNG_ROW_FILTER_ADAPTIVE; ++type) {
+                    filterPngRow(&candidate[0], row, above, length, N, PngRowFilter(type));
+                    unsigned cost = filteredPngRowCost(&candidate[0], length);
+                    if (type == PNG_ROW_FILTER_NONE || cost < bestCost) {
+                        memcpy(output, &candidate[0], rowLength);
+                        bestCost = cost;
+                    }
+                }
+            } else
+                filterPngRow(output, row, above, length, N, config.filter);
+            above = row;
+        }
+
+        size_t start = (size_t) rowLength*dictionaryRows;
+        adlers[band] = adler32(1, &filtered[start], filtered.size()-start);
+        std::vector<byte> &chunk = chunks[band];
+        startPngChunk(chunk, "IDAT");
+        if (!band) {
+            // The zlib header with the compression level indicated in the check bits as by zlib
+            int levelFlags = config.compressionLevel < 2 ? 0 : config.compressionLevel < 6 ? 1 : config.compressionLevel == 6 ? 2 : 3;
+            chunk.push_back(0x78);
+            chunk.push_back(byte(levelFlags<<6|(31-(0x7800|levelFlags<<6)%31)));
         }
-    return !lodepng::encode(filename, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+        deflateBlocks(chunk, &filtered[0], start, filtered.size(), config.compressionLevel, band == bandCount()-1);
+        finishPngChunk(chunk);
+    }
+
+    bool write(const char *filename) const {
+        static const byte signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        static const byte colorTypes[] = { 0, 0, 0, 2, 6 };
+        FILE *file = fopen(filename, "wb");
+        if (!file)
+            return false;
+        fwrite(signature, 1, sizeof(signature), file);
+        std::vector<byte> chunk;
+        startPngChunk(chunk, "IHDR");
+        chunk.resize(21);
+        storeUint32(&chunk[8], topDown.width);
+        storeUint32(&chunk[12], topDown.height);
+        // 8 bits per channel, and the default compression, filtering, and no interlacing
+        chunk[16] = 8, chunk[17] = colorTypes[N];
+        finishPngChunk(chunk);
+        fwrite(&chunk[0], 1, chunk.size(), file);
+        unsigned adler = 1;
+        for (int band = 0; band < bandCount(); ++band) {
+            fwrite(&chunks[band][0], 1, chunks[band].size(), file);
+            int y0 = band*bandRows, y1 = min(y0+bandRows, topDown.height);
+            adler = combineAdler32(adler, adlers[band], (size_t) rowLength*(y1-y0));
+        }
+        // The checksum of the whole zlib stream, which ends it
+        startPngChunk(chunk, "IDAT");
+        chunk.resize(12);
+        storeUint32(&chunk[8], adler);
+        finishPngChunk(chunk);
+        fwrite(&chunk[0], 1, chunk.size(), file);
+        startPngChunk(chunk, "IEND");
+        finishPngChunk(chunk);
+        fwrite(&chunk[0], 1, chunk.size(), file);
+        bool success = !ferror(file);
+        return !fclose(file) && success;
+    }
+
+private:
+    BitmapConstRef<T, N> topDown;
+    const PngEncoderConfig &config;
+    int rowLength, bandRows;
+    std::vector<std::vector<byte> > chunks;
+    std::vector<unsigned> adlers;
+
+};
+
+template <typename T, int N>
+static bool saveEncodedPng(const BitmapConstRef<T, N> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    if (bitmap.width <= 0 || bitmap.height <= 0)
+        return false;
+    PngBandEncoder<T, N> encoder(bitmap, config);
+    parallelFor(config.executor, encoder.bandCount(), encoder);
+    return encoder.write(filename);
+}
+
+bool savePng(const BitmapConstRef<byte, 1> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
+}
+
+bool savePng(const BitmapConstRef<byte, 3> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
+}
+
+bool savePng(const BitmapConstRef<byte, 4> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
+}
+
+bool savePng(const BitmapConstRef<float, 1> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
 }
 
+bool savePng(const BitmapConstRef<float, 3> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
+}
+
+bool savePng(const BitmapConstRef<float, 4> &bitmap, const char *filename, const PngEncoderConfig &config) {
+    return saveEncodedPng(bitmap, filename, config);
+}
+
+template <int N>
+PngRowWriter<N>::PngRowWriter() : file(NULL), png(NULL), info(NULL), width(0), height(0), rowsLeft(0), failed(false) { }
+
+template <int N>
+PngRowWriter<N>::~PngRowWriter() {
+    destroy();
+}
+
+template <int N>
+void PngRowWriter<N>::destroy() {
+#ifdef MSDFGEN_USE_LIBPNG
+    if (png) {
+        png_structp pngStruct = reinterpret_cast<png_structp>(png);
+        png_infop pngInfo = reinterpret_cast<png_infop>(info);
+        png_destroy_write_struct(&pngStruct, &pngInfo);
+    }
+#endif
+    if (file)
+        fclose(file);
+    file = NULL, png = NULL, info = NULL;
+    std::vector<byte>().swap(pixels);
+    filename.clear();
+}
+
+template <int N>
+bool PngRowWriter<N>::open(const char *filename, int width, int height) {
+    destroy();
+    this->width = width, this->height = height;
+    rowsLeft = height;
+    failed = false;
+    if (!(file = fopen(filename, "wb")))
+        return false;
+#ifdef MSDFGEN_USE_LIBPNG
+    static const int colorTypes[] = { 0, PNG_COLOR_TYPE_GRAY, 0, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_RGB_ALPHA };
+    png_structp pngStruct = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop pngInfo = pngStruct ? png_create_info_struct(pngStruct) : NULL;
+    png = pngStruct, info = pngInfo;
+    failed = true;
+    if (!pngInfo)
+        return false;
+    if (setjmp(png_jmpbuf(pngStruct)))
+        return false;
+    png_init_io(pngStruct, file);
+    png_set_IHDR(pngStruct, pngInfo, width, height, 8, colorTypes[N], PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(pngStruct, pngInfo);
+    failed = false;
+    pixels.resize(N*width);
+#else
+    // The file is created now to report failure early, but is written by LodePNG once all rows have been passed
+    this->filename = filename;
+    pixels.reserve((size_t) N*width*height);
+#endif
+    return true;
+}
+
+template <int N>
+bool PngRowWriter<N>::close() {
+    if (!file)
+        return false;
+    bool success = !failed && !rowsLeft;
+#ifdef MSDFGEN_USE_LIBPNG
+    png_structp pngStruct = reinterpret_cast<png_structp>(png);
+    if (success) {
+        if (setjmp(png_jmpbuf(pngStruct)))
+            success = false;
+        else
+            png_write_end(pngStruct, NULL);
+    }
+    png_infop pngInfo = reinterpret_cast<png_infop>(info);
+    png_destroy_write_struct(&pngStruct, &pngInfo);
+    png = NULL, info = NULL;
+    success = !fclose(file) && success;
+    file = NULL;
+#else
+    static const LodePNGColorType colorTypes[] = { LCT_GREY, LCT_GREY, LCT_GREY, LCT_RGB, LCT_RGBA };
+    fclose(file);
+    file = NULL;
+    if (success)
+        success = !lodepng::encode(filename, pixels, width, height, colorTypes[N]);
+#endif
+    destroy();
+    return success;
+}
+
+template <int N>
+bool PngRowWriter<N>::topDown() const {
+    return true;
+}
+
+template <int N>
+bool PngRowWriter<N>::writeRow(const float *rowPixels) {
+    if (!(file && rowsLeft > 0) || failed)
+        return false;
+    --rowsLeft;
+#ifdef MSDFGEN_USE_LIBPNG
+    for (int i = 0; i < N*width; ++i)
+        pixels[i] = pixelFloatToByte(rowPixels[i]);
+    png_structp pngStruct = reinterpret_cast<png_structp>(png);
+    if (setjmp(png_jmpbuf(pngStruct))) {
+        failed = true;
+        return false;
+    }
+    png_write_row(pngStruct, &pixels[0]);
+#else
+    for (int i = 0; i < N*width; ++i)
+        pixels.push_back(pixelFloatToByte(rowPixels[i]));
+#endif
+    return true;
+}
+
+template class PngRowWriter<1>;
+template class PngRowWriter<3>;
+template class PngRowWriter<4>;
+
 }
@@ -1,10 +1,37 @@
 
 #pragma once
 
+#include <cstdio>
+#include <string>
+#include <vector>
 #include "../core/BitmapRef.hpp"
+#include "../core/RowWriter.h"
+#include "../core/Executor.h"
 
 namespace msdfgen {
 
+/// The filter applied to each row of a PNG image before compression.
+enum PngRowFilter {
+    PNG_ROW_FILTER_NONE,
+    PNG_ROW_FILTER_SUB,
+    PNG_ROW_FILTER_UP,
+    PNG_ROW_FILTER_AVERAGE,
+    PNG_ROW_FILTER_PAETH,
+    /// The filter whose output has the smallest sum of absolute values is chosen for each row.
+    PNG_ROW_FILTER_ADAPTIVE
+};
+
+/// The configuration of the built-in PNG encoder, which compresses bands of rows in parallel.
+struct PngEncoderConfig {
+    /// From 0 (uncompressed) and 1 (fastest) to 9 (smallest file).
+    int compressionLevel;
+    PngRowFilter filter;
+    /// An optional executor, such as a ThreadPool, which runs the compression of the bands. The encoded file does not depend on the number of threads.
+    Executor *executor;
+
+    inline explicit PngEncoderConfig(int compressionLevel = 6, PngRowFilter filter = PNG_ROW_FILTER_ADAPTIVE) : compressionLevel(compressionLevel), filter(filter), executor(NULL) { }
+};
+
 /// Saves the bitmap as a PNG file.
 bool savePng(const BitmapConstRef<byte, 1> &bitmap, const char *filename);
 bool savePng(const BitmapConstRef<byte, 3> &bitmap, const char *filename);
@@ -13,4 +40,41 @@ bool savePng(const BitmapConstRef<float, 1> &bitmap, const char *filename);
 bool savePng(const BitmapConstRef<float, 3> &bitmap, const char *filename);
 bool savePng(const BitmapConstRef<float, 4> &bitmap, const char *filename);
 
+/// Saves the bitmap as a PNG file with the built-in encoder, which reads the rows directly from the bitmap, and may be faster than the default one.
+bool savePng(const BitmapConstRef<byte, 1> &bitmap, const char *filename, const PngEncoderConfig &config);
+bool savePng(const BitmapConstRef<byte, 3> &bitmap, const char *filename, const PngEncoderConfig &config);
+bool savePng(const BitmapConstRef<byte, 4> &bitmap, const char *filename, const PngEncoderConfig &config);
+bool savePng(const BitmapConstRef<float, 1> &bitmap, const char *filename, const PngEncoderConfig &config);
+bool savePng(const BitmapConstRef<float, 3> &bitmap, const char *filename, const PngEncoderConfig &config);
+bool savePng(const BitmapConstRef<float, 4> &bitmap, const char *filename, const PngEncoderConfig &config);
+
+/// Writes a PNG file row by row, from the top row down. The rows are encoded as they arrive if built with libpng, or held as bytes until the file is closed otherwise.
+template <int N>
+class PngRowWriter : public RowWriter<N> {
+
+public:
+    PngRowWriter();
+    ~PngRowWriter();
+    /// Creates the file and writes its header.
+    bool open(const char *filename, int width, int height);
+    /// Finishes the file. Returns false if it could not be written completely.
+    bool close();
+    bool topDown() const;
+    bool writeRow(const float *pixels);
+
+private:
+    FILE *file;
+    void *png, *info;
+    std::vector<byte> pixels;
+    std::string filename;
+    int width, height, rowsLeft;
+    bool failed;
+
+    void destroy();
+
+    PngRowWriter(const PngRowWriter &);
+    PngRowWriter &operator=(const PngRowWriter &);
+
+};
+
 }
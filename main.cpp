@@ -13,6 +13,28 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#ifdef MSDFGEN_USE_CPP11
+    #include <mutex>
+#endif
+#if defined(__linux__) && defined(MSDFGEN_USE_CPP11)
+    // The server passes its results to clients in memory files, which are specific to Linux
+    #define MSDFGEN_SERVER_MODE
+    #include <cerrno>
+    #include <csignal>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <list>
+    #include <thread>
+#endif
 
 #include "msdfgen.h"
 #include "msdfgen-ext.h"
@@ -21,6 +43,12 @@
 
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define DEFAULT_ANGLE_THRESHOLD 3.
+// The maximum number of jobs read from a batch file before they are run
+#define BATCH_GROUP_SIZE 256
+// The maximum total size of the results kept by the server for repeated requests
+#define SERVER_CACHE_SIZE (64<<20)
+// The maximum length of a request line sent to the server
+#define SERVER_REQUEST_LIMIT (1<<20)
 
 using namespace msdfgen;
 
@@ -80,6 +108,70 @@ static bool parseUnicode(unicode_t &unicode, const char *arg) {
     return false;
 }
 
+/// Parses a character code as accepted by -font: a Unicode value, a character in apostrophes, or a glyph index prefixed by g.
+static bool parseCharCode(unsigned &code, bool &isGlyphIndex, const char *arg) {
+    isGlyphIndex = false;
+    switch (arg[0]) {
+        case 'G': case 'g':
+            isGlyphIndex = true;
+            return parseUnsignedDecOrHex(code, arg+1);
+        case 'U': case 'u':
+            ++arg;
+        default: {
+            unicode_t unicode;
+            if (!parseUnicode(unicode, arg))
+                return false;
+            code = unicode;
+            return true;
+        }
+    }
+}
+
+/// A character code or glyph index of a charset.
+struct CharsetEntry {
+    unsigned code;
+    bool isGlyphIndex;
+
+    bool operator<(const CharsetEntry &other) const {
+        return isGlyphIndex != other.isGlyphIndex ? other.isGlyphIndex : code < other.code;
+    }
+    bool operator==(const CharsetEntry &other) const {
+        return isGlyphIndex == other.isGlyphIndex && code == other.code;
+    }
+};
+
+/// Parses a comma-separated list of character codes (see parseCharCode) and inclusive ranges of them, such as 0x20-0x7E,'?',g3-g9.
+/// The resulting charset is sorted, with the character codes before the glyph indices, and each entry only occurs once.
+static bool parseCharset(std::vector<CharsetEntry> &charset, const char *arg) {
+    charset.clear();
+    while (*arg) {
+        // Split the item into its first and last code, ignoring the separators inside apostrophes
+        std::string first, last;
+        std::string *current = &first;
+        for (bool quoted = false; *arg && (quoted || *arg != ','); ++arg) {
+            if (*arg == '\'')
+                quoted = !quoted;
+            if (*arg == '-' && !quoted && !current->empty() && current == &first)
+                current = &last;
+            else
+                current->push_back(*arg);
+        }
+        if (*arg)
+            ++arg;
+        CharsetEntry begin, end;
+        if (!parseCharCode(begin.code, begin.isGlyphIndex, first.c_str()))
+            return false;
+        end = begin;
+        if (current == &last && (!parseCharCode(end.code, end.isGlyphIndex, last.c_str()) || end.isGlyphIndex != begin.isGlyphIndex || end.code < begin.code || end.code-begin.code > 0x10ffff))
+            return false;
+        for (CharsetEntry entry = begin; entry.code <= end.code && entry.code >= begin.code; ++entry.code)
+            charset.push_back(entry);
+    }
+    std::sort(charset.begin(), charset.end());
+    charset.erase(std::unique(charset.begin(), charset.end()), charset.end());
+    return !charset.empty();
+}
+
 static bool parseAngle(double &value, const char *arg) {
     char c1, c2;
     int result = sscanf(arg, "%lf%c%c", &value, &c1, &c2);
@@ -137,9 +229,11 @@ static void parseColoring(Shape &shape, const char *edgeAssignment) {
 
 template <int N>
 static void invertColor(const BitmapRef<float, N> &bitmap) {
-    const float *end = bitmap.pixels+N*bitmap.width*bitmap.height;
-    for (float *p = bitmap.pixels; p < end; ++p)
-        *p = 1.f-*p;
+    for (int y = 0; y < bitmap.height; ++y) {
+        float *p = bitmap(0, y);
+        for (float *end = p+N*bitmap.width; p < end; ++p)
+            *p = 1.f-*p;
+    }
 }
 
 static bool writeTextBitmap(FILE *file, const float *values, int cols, int rows) {
@@ -201,57 +295,269 @@ static bool cmpExtension(const char *path, const char *ext) {
     return true;
 }
 
+static const char * resolveFormat(const char *filename, Format &format) {
+    if (filename && format == AUTO) {
+        if (cmpExtension(filename, ".png")) format = PNG;
+        else if (cmpExtension(filename, ".bmp")) format = BMP;
+        else if (cmpExtension(filename, ".tif") || cmpExtension(filename, ".tiff")) format = TIFF;
+        else if (cmpExtension(filename, ".txt")) format = TEXT;
+        else if (cmpExtension(filename, ".bin")) format = BINARY;
+        else
+            return "Could not deduce format from output file name.";
+    }
+    return NULL;
+}
+
+/// Returns the name of the format as accepted by -format.
+static const char * formatName(Format format) {
+    switch (format) {
+        case PNG: return "png";
+        case BMP: return "bmp";
+        case TIFF: return "tiff";
+        case TEXT: return "text";
+        case TEXT_FLOAT: return "textfloat";
+        case BINARY: return "bin";
+        case BINARY_FLOAT: return "binfloat";
+        case BINARY_FLOAT_BE: return "binfloatbe";
+        default: return NULL;
+    }
+}
+
+/// Returns the file name extension of the format.
+static const char * formatExtension(Format format) {
+    switch (format) {
+        case PNG: return "png";
+        case BMP: return "bmp";
+        case TIFF: return "tif";
+        case TEXT: case TEXT_FLOAT: return "txt";
+        case BINARY: case BINARY_FLOAT: case BINARY_FLOAT_BE: return "bin";
+        default: return NULL;
+    }
+}
+
+/// Saves the bitmap as a PNG file with the built-in encoder if its configuration is specified, or the default one otherwise.
+template <class B>
+static bool savePngOutput(const B &bitmap, const char *filename, const PngEncoderConfig *pngConfig) {
+    return pngConfig ? savePng(bitmap, filename, *pngConfig) : savePng(bitmap, filename);
+}
+
+/// Saves the bitmap as a TIFF file with the parallel encoder if its configuration is specified, or uncompressed otherwise.
 template <int N>
-static const char * writeOutput(const BitmapConstRef<float, N> &bitmap, const char *filename, Format &format) {
+static bool saveTiffOutput(const BitmapConstRef<float, N> &bitmap, const char *filename, const TiffEncoderConfig *tiffConfig) {
+    return tiffConfig ? saveTiff(bitmap, filename, *tiffConfig) : saveTiff(bitmap, filename);
+}
+
+template <int N>
+static const char * writeOutput(const BitmapConstRef<float, N> &bitmap, const char *filename, Format &format, const PngEncoderConfig *pngConfig, const TiffEncoderConfig *tiffConfig, FILE *out) {
     if (filename) {
-        if (format == AUTO) {
-            if (cmpExtension(filename, ".png")) format = PNG;
-            else if (cmpExtension(filename, ".bmp")) format = BMP;
-            else if (cmpExtension(filename, ".tif") || cmpExtension(filename, ".tiff")) format = TIFF;
-            else if (cmpExtension(filename, ".txt")) format = TEXT;
-            else if (cmpExtension(filename, ".bin")) format = BINARY;
-            else
-                return "Could not deduce format from output file name.";
-        }
+        const char *error = resolveFormat(filename, format);
+        if (error)
+            return error;
         switch (format) {
-            case PNG: return savePng(bitmap, filename) ? NULL : "Failed to write output PNG image.";
+            case PNG: return savePngOutput(bitmap, filename, pngConfig) ? NULL : "Failed to write output PNG image.";
             case BMP: return saveBmp(bitmap, filename) ? NULL : "Failed to write output BMP image.";
-            case TIFF: return saveTiff(bitmap, filename) ? NULL : "Failed to write output TIFF image.";
+            case TIFF: return saveTiffOutput(bitmap, filename, tiffConfig) ? NULL : "Failed to write output TIFF image.";
             case TEXT: case TEXT_FLOAT: {
                 FILE *file = fopen(filename, "w");
                 if (!file) return "Failed to write output text file.";
-                if (format == TEXT)
-                    writeTextBitmap(file, bitmap.pixels, N*bitmap.width, bitmap.height);
-                else if (format == TEXT_FLOAT)
-                    writeTextBitmapFloat(file, bitmap.pixels, N*bitmap.width, bitmap.height);
+                for (int y = 0; y < bitmap.height; ++y) {
+                    if (format == TEXT)
+                        writeTextBitmap(file, bitmap(0, y), N*bitmap.width, 1);
+                    else if (format == TEXT_FLOAT)
+                        writeTextBitmapFloat(file, bitmap(0, y), N*bitmap.width, 1);
+                }
                 fclose(file);
                 return NULL;
             }
             case BINARY: case BINARY_FLOAT: case BINARY_FLOAT_BE: {
                 FILE *file = fopen(filename, "wb");
                 if (!file) return "Failed to write output binary file.";
-                if (format == BINARY)
-                    writeBinBitmap(file, bitmap.pixels, N*bitmap.width*bitmap.height);
-                else if (format == BINARY_FLOAT)
-                    writeBinBitmapFloat(file, bitmap.pixels, N*bitmap.width*bitmap.height);
-                else if (format == BINARY_FLOAT_BE)
-                    writeBinBitmapFloatBE(file, bitmap.pixels, N*bitmap.width*bitmap.height);
+                for (int y = 0; y < bitmap.height; ++y) {
+                    if (format == BINARY)
+                        writeBinBitmap(file, bitmap(0, y), N*bitmap.width);
+                    else if (format == BINARY_FLOAT)
+                        writeBinBitmapFloat(file, bitmap(0, y), N*bitmap.width);
+                    else if (format == BINARY_FLOAT_BE)
+                        writeBinBitmapFloatBE(file, bitmap(0, y), N*bitmap.width);
+                }
                 fclose(file);
                 return NULL;
             }
             default:;
         }
     } else {
-        if (format == AUTO || format == TEXT)
-            writeTextBitmap(stdout, bitmap.pixels, N*bitmap.width, bitmap.height);
-        else if (format == TEXT_FLOAT)
-            writeTextBitmapFloat(stdout, bitmap.pixels, N*bitmap.width, bitmap.height);
-        else
+        if (!(format == AUTO || format == TEXT || format == TEXT_FLOAT))
             return "Unsupported format for standard output.";
+        for (int y = 0; y < bitmap.height; ++y) {
+            if (format == TEXT_FLOAT)
+                writeTextBitmapFloat(out, bitmap(0, y), N*bitmap.width, 1);
+            else
+                writeTextBitmap(out, bitmap(0, y), N*bitmap.width, 1);
+        }
     }
     return NULL;
 }
 
+static bool isRowOutputFormat(const char *filename, Format format) {
+    if (filename)
+        return format != AUTO && format != BMP;
+    return format == AUTO || format == TEXT || format == TEXT_FLOAT;
+}
+
+/// Writes the output row by row in a format that allows it, applying the orientation and distance shift to each row. Text output without a file name is written to out.
+template <int N>
+class OutputRowWriter : public RowWriter<N> {
+
+public:
+    OutputRowWriter(bool invert, float distanceShift, FILE *out) : invert(invert), distanceShift(distanceShift), format(AUTO), width(0), file(NULL), out(out), failed(false) { }
+
+    ~OutputRowWriter() {
+        close();
+    }
+
+    const char * open(const char *filename, Format format, int width, int height) {
+        this->format = filename || format == TEXT_FLOAT ? format : TEXT;
+        this->width = width;
+        failed = false;
+        row.resize(N*width);
+        switch (this->format) {
+            case PNG: return png.open(filename, width, height) ? NULL : "Failed to write output PNG image.";
+            case TIFF: return tiff.open(filename, width, height) ? NULL : "Failed to write output TIFF image.";
+            case TEXT: case TEXT_FLOAT:
+                file = filename ? fopen(filename, "w") : out;
+                return file ? NULL : "Failed to write output text file.";
+            case BINARY: case BINARY_FLOAT: case BINARY_FLOAT_BE:
+                file = fopen(filename, "wb");
+                return file ? NULL : "Failed to write output binary file.";
+            default:
+                return "Unsupported format for row by row output.";
+        }
+    }
+
+    const char * close() {
+        switch (format) {
+            case PNG: return png.close() ? NULL : "Failed to write output PNG image.";
+            case TIFF: return tiff.close() ? NULL : "Failed to write output TIFF image.";
+            default: {
+                bool success = !failed;
+                if (file && file != out)
+                    success = !fclose(file) && success;
+                file = NULL;
+                return success ? NULL : format == TEXT || format == TEXT_FLOAT ? "Failed to write output text file." : "Failed to write output binary file.";
+            }
+        }
+    }
+
+    bool topDown() const {
+        return format == PNG || format == TIFF;
+    }
+
+    bool writeRow(const float *pixels) {
+        for (int i = 0; i < N*width; ++i) {
+            row[i] = invert ? 1.f-pixels[i] : pixels[i];
+            if (distanceShift)
+                row[i] += distanceShift;
+        }
+        bool success = false;
+        switch (format) {
+            case PNG: success = png.writeRow(&row[0]); break;
+            case TIFF: success = tiff.writeRow(&row[0]); break;
+            case TEXT: success = writeTextBitmap(file, &row[0], N*width, 1); break;
+            case TEXT_FLOAT: success = writeTextBitmapFloat(file, &row[0], N*width, 1); break;
+            case BINARY: success = writeBinBitmap(file, &row[0], N*width); break;
+            case BINARY_FLOAT: success = writeBinBitmapFloat(file, &row[0], N*width); break;
+            case BINARY_FLOAT_BE: success = writeBinBitmapFloatBE(file, &row[0], N*width); break;
+            default:;
+        }
+        failed |= !success;
+        return success;
+    }
+
+private:
+    bool invert;
+    float distanceShift;
+    Format format;
+    int width;
+    std::vector<float> row;
+    PngRowWriter<N> png;
+    TiffRowWriter<N> tiff;
+    FILE *file, *out;
+    bool failed;
+
+};
+
+/// Generates the distance field with one of the row by row generator functions directly into the output file.
+template <int N, class Config>
+static const char * generateOutputRows(bool (*generate)(RowWriter<N> &, int, int, const Shape &, double, const Vector2 &, const Vector2 &, const Config &), const char *filename, Format format, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const Config &config, bool invert, float distanceShift, FILE *out) {
+    OutputRowWriter<N> writer(invert, distanceShift, out);
+    const char *error = writer.open(filename, format, width, height);
+    if (error)
+        return error;
+    bool success = generate(writer, width, height, shape, range, scale, translate, config);
+    error = writer.close();
+    if (!error && !success)
+        return "Failed to write output file.";
+    return error;
+}
+
+/// Keeps the fonts used by the jobs of a batch or server open for the following ones. Glyphs are loaded one at a time, since a FreeType face may not be used by multiple threads at once.
+class FontCache {
+
+public:
+    FontCache() : ft(NULL) { }
+
+    ~FontCache() {
+        for (std::map<std::string, FontHandle *>::iterator font = fonts.begin(); font != fonts.end(); ++font)
+            if (font->second)
+                destroyFont(font->second);
+        if (ft)
+            deinitializeFreetype(ft);
+    }
+
+    /// Loads the glyph with the character code unicode, or glyphIndex if it is zero, from the font file. Returns an error message on failure.
+    const char * loadGlyph(Shape &shape, const char *filename, GlyphIndex glyphIndex, unicode_t unicode, double *advance) {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        if (!ft && !(ft = initializeFreetype()))
+            return "Failed to initialize FreeType.";
+        std::map<std::string, FontHandle *>::iterator font = fonts.find(filename);
+        if (font == fonts.end())
+            font = fonts.insert(std::make_pair(std::string(filename), loadFont(ft, filename))).first;
+        if (!font->second)
+            return "Failed to load font file.";
+        if (unicode)
+            getGlyphIndex(glyphIndex, font->second, unicode);
+        if (!msdfgen::loadGlyph(shape, font->second, glyphIndex, advance))
+            return "Failed to load glyph from font file.";
+        return NULL;
+    }
+
+    /// Closes the font file if it is open, so that it is loaded again by the next glyph requested from it.
+    void unloadFont(const char *filename) {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        std::map<std::string, FontHandle *>::iterator font = fonts.find(filename);
+        if (font != fonts.end()) {
+            if (font->second)
+                destroyFont(font->second);
+            fonts.erase(font);
+        }
+    }
+
+private:
+    FreetypeHandle *ft;
+    std::map<std::string, FontHandle *> fonts;
+#ifdef MSDFGEN_USE_CPP11
+    std::mutex mutex;
+#endif
+
+    FontCache(const FontCache &);
+    FontCache &operator=(const FontCache &);
+
+};
+
 #if defined(MSDFGEN_USE_SKIA) && defined(MSDFGEN_USE_OPENMP)
     #define TITLE_SUFFIX    " with Skia & OpenMP"
     #define EXTRA_UNDERLINE "-------------------"
@@ -288,7 +594,7 @@ static const char *helpText =
         "\tDefines input shape using the ad-hoc text definition.\n"
     "  -font <filename.ttf> <character code>\n"
         "\tLoads a single glyph from the specified font file.\n"
-        "\tFormat of character code is '?', 63, 0x3F (Unicode value), or g34 (glyph index).\n"
+        "\tFormat of character code is '?', 63, 0x3F (Unicode value), or g34 (glyph index). It is omitted if -charset is used.\n"
     "  -shapedesc <filename.txt>\n"
         "\tLoads text shape description from a file.\n"
     "  -stdin\n"
@@ -304,8 +610,16 @@ static const char *helpText =
         "\tSets the scale used to convert shape units to pixels asymmetrically.\n"
     "  -autoframe\n"
         "\tAutomatically scales (unless specified) and translates the shape to fit.\n"
+    "  -batch <filename.txt / ->\n"
+        "\tRuns the jobs listed in the file or the standard input, one per line with the same arguments as the command line, which follow the other arguments.\n"
+        "\tAn empty line runs the jobs read so far and prints the status of each.\n"
+    "  -charset <charset>\n"
+        "\tGenerates every glyph of the charset from the font in parallel, into the directory if the output name ends with a slash, or a single file otherwise.\n"
+        "\tThe charset is a comma-separated list of character codes and ranges, such as 0x20-0x7E,'?'. A manifest with the metrics of each glyph is printed.\n"
     "  -coloringstrategy <simple / inktrap>\n"
         "\tSelects the strategy of the edge coloring heuristic.\n"
+    "  -cubictolerance <pixels>\n"
+        "\tApproximates cubic curves with quadratic pieces deviating from them by at most the given distance. Faster for cubic-heavy shapes.\n"
     "  -distanceshift <shift>\n"
         "\tShifts all normalized distances in the output distance field by this value.\n"
     "  -edgecolors <sequence>\n"
@@ -324,8 +638,14 @@ static const char *helpText =
         "\tAttempts to detect if shape contours have the wrong winding and generates the SDF with the right one.\n"
     "  -help\n"
         "\tDisplays this help.\n"
+    "  -interpolate <pixels>\n"
+        "\tEnables narrow band mode and interpolates cells of pixels that deviate from bilinear interpolation by at most the tolerance at sampled points.\n"
     "  -legacy\n"
         "\tUses the original (legacy) distance field algorithms.\n"
+    "  -maxerror <error>\n"
+        "\tEnables error estimation and stops it once the error exceeds this value, in which case a lower bound is printed.\n"
+    "  -narrowband\n"
+        "\tSkips the computation of pixels too far from the shape to fit the range and saturates them instead.\n"
 #ifdef MSDFGEN_USE_SKIA
     "  -nopreprocess\n"
         "\tDisables path preprocessing which resolves self-intersections and overlapping contours.\n"
@@ -341,6 +661,10 @@ static const char *helpText =
     "  -overlap\n"
         "\tSwitches to distance field generator with support for overlapping contours.\n"
 #endif
+    "  -pngfilter <none / sub / up / average / paeth / adaptive>\n"
+        "\tEncodes PNG images with the built-in parallel encoder, which applies this filter to every row (adaptive chooses one per row).\n"
+    "  -pnglevel <0 - 9>\n"
+        "\tEncodes PNG images with the built-in parallel encoder at this compression level, from 0 (uncompressed) and 1 (fastest) to 9 (smallest).\n"
     "  -printmetrics\n"
         "\tPrints relevant metrics of the shape to the standard output.\n"
     "  -pxrange <range>\n"
@@ -357,6 +681,13 @@ static const char *helpText =
 #endif
     "  -seed <n>\n"
         "\tSets the random seed for edge coloring heuristic.\n"
+#ifdef MSDFGEN_SERVER_MODE
+    "  -server <socket>\n"
+        "\tListens on a Unix domain socket for lines with the arguments of jobs, and passes their outputs to the clients in memory files.\n"
+        "\tThe jobs of different connections run concurrently, while each connection is answered in order.\n"
+#endif
+    "  -singleprecision\n"
+        "\tComputes the distances in single precision, which is faster but less accurate for large coordinates.\n"
     "  -size <width> <height>\n"
         "\tSets the dimensions of the output image.\n"
     "  -stdout\n"
@@ -365,14 +696,41 @@ static const char *helpText =
         "\tRenders an image preview using the generated distance field and saves it as a PNG file.\n"
     "  -testrendermulti <filename.png> <width> <height>\n"
         "\tRenders an image preview without flattening the color channels.\n"
+#ifdef MSDFGEN_USE_CPP11
+    "  -threads <n>\n"
+        "\tRuns the parallel stages on a pool of n threads (shared by the requests to a server), or this many jobs of a batch at once.\n"
+#endif
+    "  -tiffcompression <none / lzw / deflate>\n"
+        "\tEncodes TIFF images in parallel strips (or tiles) with this compression, which applies the floating-point predictor.\n"
+    "  -tifftile <size>\n"
+        "\tEncodes TIFF images in parallel as square tiles of this size (a multiple of 16), so that regions may be read separately.\n"
     "  -translate <x> <y>\n"
         "\tSets the translation of the shape in shape units.\n"
+    "  -traversal <rows / tiles>\n"
+        "\tSelects the order in which pixels are computed. Tiles are distributed among threads dynamically.\n"
     "  -yflip\n"
         "\tInverts the Y axis in the output distance field. The default order is bottom to top.\n"
     "\n";
 
-int main(int argc, const char * const *argv) {
-    #define ABORT(msg) { puts(msg); return 1; }
+/// The placement of a job's shape in its distance field.
+struct JobMetrics {
+    Shape::Bounds bounds;
+    double advance;
+    Vector2 scale, translate;
+    double range;
+};
+
+static int runBatch(const char *filename, const std::vector<const char *> &commonArgs, unsigned threadCount);
+static int runCharset(const char *fontFilename, const std::vector<CharsetEntry> &charset, const char *output, Format format, const std::vector<const char *> &commonArgs, unsigned threadCount, FILE *out);
+#ifdef MSDFGEN_SERVER_MODE
+static int runServer(const char *socketPath, const std::vector<const char *> &commonArgs, unsigned threadCount);
+#endif
+
+/// Runs the program with the command line arguments, printing messages to out.
+/// If jobExecutor is not null, runs a job of a batch or server, whose parallel stages run on jobExecutor, with the common resources of the batch or server.
+/// If metrics is not null, it receives the placement of the shape.
+static int runJob(int argc, const char * const *argv, FILE *out, FontCache &fontCache, Executor *jobExecutor, JobMetrics *metrics = NULL) {
+    #define ABORT(msg) { fprintf(out, "%s\n", msg); return 1; }
 
     // Parse command line arguments
     enum {
@@ -399,6 +757,12 @@ int main(int argc, const char * const *argv) {
         #endif
     );
     bool overlapSupport = !geometryPreproc;
+    bool narrowBand = false;
+    double interpolationTolerance = 0;
+    double cubicTolerance = 0;
+    bool singlePrecision = false;
+    PixelTraversal traversal = ROW_TRAVERSAL;
+    unsigned threadCount = 0;
     bool scanlinePass = !geometryPreproc;
     FillRule fillRule = FILL_NONZERO;
     Format format = AUTO;
@@ -407,7 +771,17 @@ int main(int argc, const char * const *argv) {
     const char *shapeExport = NULL;
     const char *testRender = NULL;
     const char *testRenderMulti = NULL;
+    const char *batchInput = NULL;
+    const char *serverSocket = NULL;
+    int jobSourceArgPos = 0;
+    const char *charsetArg = NULL;
+    int charsetArgPos = 0;
+    int fontArgPos = 0, fontArgEnd = 0;
     bool outputSpecified = false;
+    PngEncoderConfig pngConfig;
+    bool pngConfigSpecified = false;
+    TiffEncoderConfig tiffConfig;
+    bool tiffConfigSpecified = false;
     GlyphIndex glyphIndex;
     unicode_t unicode = 0;
     int svgPathIndex = 0;
@@ -432,6 +806,7 @@ int main(int argc, const char * const *argv) {
     bool yFlip = false;
     bool printMetrics = false;
     bool estimateError = false;
+    double errorLimit = 0;
     bool skipColoring = false;
     enum {
         KEEP,
@@ -461,22 +836,32 @@ int main(int argc, const char * const *argv) {
             argPos += 2;
             continue;
         }
-        ARG_CASE("-font", 2) {
+        ARG_CASE("-font", 1) {
             inputType = FONT;
             input = argv[argPos+1];
-            const char *charArg = argv[argPos+2];
-            unsigned gi;
-            switch (charArg[0]) {
-                case 'G': case 'g':
-                    if (parseUnsignedDecOrHex(gi, charArg+1))
-                        glyphIndex = GlyphIndex(gi);
-                    break;
-                case 'U': case 'u':
-                    ++charArg;
-                default:
-                    parseUnicode(unicode, charArg);
+            fontArgPos = argPos;
+            argPos += 2;
+            // The character code is omitted if the glyphs are specified by -charset
+            if (argPos < argc && argv[argPos][0] != '-') {
+                unsigned code;
+                bool isGlyphIndex;
+                if (parseCharCode(code, isGlyphIndex, argv[argPos])) {
+                    if (isGlyphIndex)
+                        glyphIndex = GlyphIndex(code);
+                    else
+                        unicode = code;
+                }
+                ++argPos;
             }
-            argPos += 3;
+            fontArgEnd = argPos;
+            continue;
+        }
+        ARG_CASE("-charset", 1) {
+            if (jobExecutor)
+                ABORT("The jobs of a batch or server cannot generate charsets.");
+            charsetArg = argv[argPos+1];
+            charsetArgPos = argPos;
+            argPos += 2;
             continue;
         }
         ARG_CASE("-defineshape", 1) {
@@ -497,12 +882,71 @@ int main(int argc, const char * const *argv) {
             argPos += 2;
             continue;
         }
+        ARG_CASE("-batch", 1) {
+            if (jobExecutor)
+                ABORT("The jobs of a batch or server cannot run batches.");
+            batchInput = argv[argPos+1];
+            jobSourceArgPos = argPos;
+            argPos += 2;
+            continue;
+        }
+#ifdef MSDFGEN_SERVER_MODE
+        ARG_CASE("-server", 1) {
+            if (jobExecutor)
+                ABORT("The jobs of a batch or server cannot run servers.");
+            serverSocket = argv[argPos+1];
+            jobSourceArgPos = argPos;
+            argPos += 2;
+            continue;
+        }
+#endif
         ARG_CASE("-o", 1) {
             output = argv[argPos+1];
             outputSpecified = true;
             argPos += 2;
             continue;
         }
+        ARG_CASE("-pngfilter", 1) {
+            if (!strcmp(argv[argPos+1], "none")) pngConfig.filter = PNG_ROW_FILTER_NONE;
+            else if (!strcmp(argv[argPos+1], "sub")) pngConfig.filter = PNG_ROW_FILTER_SUB;
+            else if (!strcmp(argv[argPos+1], "up")) pngConfig.filter = PNG_ROW_FILTER_UP;
+            else if (!strcmp(argv[argPos+1], "average")) pngConfig.filter = PNG_ROW_FILTER_AVERAGE;
+            else if (!strcmp(argv[argPos+1], "paeth")) pngConfig.filter = PNG_ROW_FILTER_PAETH;
+            else if (!strcmp(argv[argPos+1], "adaptive")) pngConfig.filter = PNG_ROW_FILTER_ADAPTIVE;
+            else
+                ABORT("Unknown PNG filter specified. Use -pngfilter <none / sub / up / average / paeth / adaptive>.");
+            pngConfigSpecified = true;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-pnglevel", 1) {
+            unsigned level;
+            if (!parseUnsigned(level, argv[argPos+1]) || level > 9)
+                ABORT("Invalid PNG compression level. Use -pnglevel <0 - 9>.");
+            pngConfig.compressionLevel = int(level);
+            pngConfigSpecified = true;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-tiffcompression", 1) {
+            if (!strcmp(argv[argPos+1], "none")) tiffConfig.compression = TIFF_COMPRESSION_NONE;
+            else if (!strcmp(argv[argPos+1], "lzw")) tiffConfig.compression = TIFF_COMPRESSION_LZW;
+            else if (!strcmp(argv[argPos+1], "deflate")) tiffConfig.compression = TIFF_COMPRESSION_DEFLATE;
+            else
+                ABORT("Unknown TIFF compression specified. Use -tiffcompression <none / lzw / deflate>.");
+            tiffConfigSpecified = true;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-tifftile", 1) {
+            unsigned size;
+            if (!parseUnsigned(size, argv[argPos+1]) || !size || size%16)
+                ABORT("Invalid TIFF tile size. Use -tifftile <size> with a positive multiple of 16.");
+            tiffConfig.tileSize = int(size);
+            tiffConfigSpecified = true;
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-stdout", 0) {
             output = NULL;
             argPos += 1;
@@ -523,6 +967,25 @@ int main(int argc, const char * const *argv) {
             argPos += 1;
             continue;
         }
+        ARG_CASE("-narrowband", 0) {
+            narrowBand = true;
+            argPos += 1;
+            continue;
+        }
+        ARG_CASE("-interpolate", 1) {
+            double it;
+            if (!parseDouble(it, argv[argPos+1]) || it < 0)
+                ABORT("Invalid interpolation tolerance. Use -interpolate <pixels> with a non-negative real number.");
+            interpolationTolerance = it;
+            narrowBand = true;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-singleprecision", 0) {
+            singlePrecision = true;
+            argPos += 1;
+            continue;
+        }
         ARG_CASE("-nooverlap", 0) {
             overlapSupport = false;
             argPos += 1;
@@ -550,7 +1013,7 @@ int main(int argc, const char * const *argv) {
             else if (!strcmp(argv[argPos+1], "positive")) fillRule = FILL_POSITIVE;
             else if (!strcmp(argv[argPos+1], "negative")) fillRule = FILL_NEGATIVE;
             else
-                puts("Unknown fill rule specified.");
+                fprintf(out, "Unknown fill rule specified.\n");
             argPos += 2;
             continue;
         }
@@ -565,7 +1028,7 @@ int main(int argc, const char * const *argv) {
             else if (!strcmp(argv[argPos+1], "binfloat") || !strcmp(argv[argPos+1], "binfloatle")) SET_FORMAT(BINARY_FLOAT, "bin");
             else if (!strcmp(argv[argPos+1], "binfloatbe")) SET_FORMAT(BINARY_FLOAT_BE, "bin");
             else
-                puts("Unknown format specified.");
+                fprintf(out, "Unknown format specified.\n");
             argPos += 2;
             continue;
         }
@@ -618,6 +1081,16 @@ int main(int argc, const char * const *argv) {
             argPos += 3;
             continue;
         }
+#ifdef MSDFGEN_USE_CPP11
+        ARG_CASE("-threads", 1) {
+            unsigned tc;
+            if (!parseUnsigned(tc, argv[argPos+1]) || !tc)
+                ABORT("Invalid thread count. Use -threads <n> with a positive integer.");
+            threadCount = tc;
+            argPos += 2;
+            continue;
+        }
+#endif
         ARG_CASE("-translate", 2) {
             double tx, ty;
             if (!parseDouble(tx, argv[argPos+1]) || !parseDouble(ty, argv[argPos+2]))
@@ -634,6 +1107,14 @@ int main(int argc, const char * const *argv) {
             argPos += 2;
             continue;
         }
+        ARG_CASE("-cubictolerance", 1) {
+            double ct;
+            if (!parseDouble(ct, argv[argPos+1]) || ct < 0)
+                ABORT("Invalid cubic tolerance. Use -cubictolerance <pixels> with a non-negative real number.");
+            cubicTolerance = ct;
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-errorcorrection", 1) {
             double ect;
             if (!parseDouble(ect, argv[argPos+1]) && (ect >= 1 || ect == 0))
@@ -646,7 +1127,15 @@ int main(int argc, const char * const *argv) {
             if (!strcmp(argv[argPos+1], "simple")) edgeColoring = edgeColoringSimple;
             else if (!strcmp(argv[argPos+1], "inktrap")) edgeColoring = edgeColoringInkTrap;
             else
-                puts("Unknown coloring strategy specified.");
+                fprintf(out, "Unknown coloring strategy specified.\n");
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-traversal", 1) {
+            if (!strcmp(argv[argPos+1], "rows")) traversal = ROW_TRAVERSAL;
+            else if (!strcmp(argv[argPos+1], "tiles")) traversal = TILE_TRAVERSAL;
+            else
+                fprintf(out, "Unknown traversal order specified.\n");
             argPos += 2;
             continue;
         }
@@ -709,6 +1198,15 @@ int main(int argc, const char * const *argv) {
             argPos += 1;
             continue;
         }
+        ARG_CASE("-maxerror", 1) {
+            double me;
+            if (!parseDouble(me, argv[argPos+1]) || me <= 0)
+                ABORT("Invalid error limit. Use -maxerror <error> with a positive real number.");
+            errorLimit = me;
+            estimateError = true;
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-keeporder", 0) {
             orientation = KEEP;
             argPos += 1;
@@ -731,15 +1229,46 @@ int main(int argc, const char * const *argv) {
             continue;
         }
         ARG_CASE("-help", 0) {
-            puts(helpText);
+            fprintf(out, "%s\n", helpText);
             return 0;
         }
-        printf("Unknown setting or insufficient parameters: %s\n", arg);
+        fprintf(out, "Unknown setting or insufficient parameters: %s\n", arg);
         suggestHelp = true;
         ++argPos;
     }
     if (suggestHelp)
-        printf("Use -help for more information.\n");
+        fprintf(out, "Use -help for more information.\n");
+
+    // Run batch or server
+    if (batchInput || serverSocket) {
+        if (batchInput && serverSocket)
+            ABORT("Cannot run a batch and a server at once.");
+        std::vector<const char *> commonArgs;
+        for (int i = 0; i < argc; ++i)
+            if (i != jobSourceArgPos && i != jobSourceArgPos+1)
+                commonArgs.push_back(argv[i]);
+#ifdef MSDFGEN_SERVER_MODE
+        if (serverSocket)
+            return runServer(serverSocket, commonArgs, threadCount);
+#endif
+        return runBatch(batchInput, commonArgs, threadCount);
+    }
+
+    // Run charset
+    if (charsetArg) {
+        std::vector<CharsetEntry> charset;
+        if (inputType != FONT)
+            ABORT("A charset can only be generated from a font. Use -font <file.ttf/otf> -charset <charset>.");
+        if (!parseCharset(charset, charsetArg))
+            ABORT("Invalid charset. Use a comma-separated list of character codes and ranges, such as 0x20-0x7E,'?'.");
+        if (!output)
+            ABORT("A charset cannot be printed to the standard output.");
+        std::vector<const char *> commonArgs;
+        for (int i = 0; i < argc; ++i)
+            if (i != charsetArgPos && i != charsetArgPos+1 && !(i >= fontArgPos && i < fontArgEnd))
+                commonArgs.push_back(argv[i]);
+        return runCharset(input, charset, output, format, commonArgs, threadCount, out);
+    }
 
     // Load input
     Vector2 svgDims;
@@ -758,22 +1287,9 @@ int main(int argc, const char * const *argv) {
         case FONT: {
             if (!glyphIndex && !unicode)
                 ABORT("No character specified! Use -font <file.ttf/otf> <character code>. Character code can be a Unicode index (65, 0x41), a character in apostrophes ('A'), or a glyph index prefixed by g (g36, g0x24).");
-            FreetypeHandle *ft = initializeFreetype();
-            if (!ft) return -1;
-            FontHandle *font = loadFont(ft, input);
-            if (!font) {
-                deinitializeFreetype(ft);
-                ABORT("Failed to load font file.");
-            }
-            if (unicode)
-                getGlyphIndex(glyphIndex, font, unicode);
-            if (!loadGlyph(shape, font, glyphIndex, &glyphAdvance)) {
-                destroyFont(font);
-                deinitializeFreetype(ft);
-                ABORT("Failed to load glyph from font file.");
-            }
-            destroyFont(font);
-            deinitializeFreetype(ft);
+            const char *error = fontCache.loadGlyph(shape, input, glyphIndex, unicode, &glyphAdvance);
+            if (error)
+                ABORT(error);
             break;
         }
         case DESCRIPTION_ARG: {
@@ -782,6 +1298,8 @@ int main(int argc, const char * const *argv) {
             break;
         }
         case DESCRIPTION_STDIN: {
+            if (jobExecutor)
+                ABORT("The standard input cannot be read by the jobs of a batch or server.");
             if (!readShapeDescription(stdin, shape, &skipColoring))
                 ABORT("Parse error in shape description.");
             break;
@@ -804,7 +1322,7 @@ int main(int argc, const char * const *argv) {
     if (geometryPreproc) {
         #ifdef MSDFGEN_USE_SKIA
             if (!resolveShapeGeometry(shape))
-                puts("Shape geometry preprocessing failed, skipping.");
+                fprintf(out, "Shape geometry preprocessing failed, skipping.\n");
         #else
             ABORT("Shape geometry preprocessing (-preprocess) is not available in this version because the Skia library is not present.");
         #endif
@@ -815,7 +1333,7 @@ int main(int argc, const char * const *argv) {
 
     double avgScale = .5*(scale.x+scale.y);
     Shape::Bounds bounds = { };
-    if (autoFrame || mode == METRICS || printMetrics || orientation == GUESS)
+    if (autoFrame || mode == METRICS || printMetrics || orientation == GUESS || metrics)
         bounds = shape.getBounds();
 
     // Auto-frame
@@ -852,33 +1370,122 @@ int main(int argc, const char * const *argv) {
     if (rangeMode == RANGE_PX)
         range = pxRange/min(scale.x, scale.y);
 
+    if (metrics) {
+        metrics->bounds = bounds;
+        metrics->advance = glyphAdvance;
+        metrics->scale = scale;
+        metrics->translate = translate;
+        metrics->range = range;
+    }
+
     // Print metrics
     if (mode == METRICS || printMetrics) {
-        FILE *out = stdout;
+        FILE *metricsFile = out;
         if (mode == METRICS && outputSpecified)
-            out = fopen(output, "w");
-        if (!out)
+            metricsFile = fopen(output, "w");
+        if (!metricsFile)
             ABORT("Failed to write output file.");
         if (shape.inverseYAxis)
-            fprintf(out, "inverseY = true\n");
+            fprintf(metricsFile, "inverseY = true\n");
         if (bounds.r >= bounds.l && bounds.t >= bounds.b)
-            fprintf(out, "bounds = %.12g, %.12g, %.12g, %.12g\n", bounds.l, bounds.b, bounds.r, bounds.t);
+            fprintf(metricsFile, "bounds = %.12g, %.12g, %.12g, %.12g\n", bounds.l, bounds.b, bounds.r, bounds.t);
         if (svgDims.x != 0 && svgDims.y != 0)
-            fprintf(out, "dimensions = %.12g, %.12g\n", svgDims.x, svgDims.y);
+            fprintf(metricsFile, "dimensions = %.12g, %.12g\n", svgDims.x, svgDims.y);
         if (glyphAdvance != 0)
-            fprintf(out, "advance = %.12g\n", glyphAdvance);
+            fprintf(metricsFile, "advance = %.12g\n", glyphAdvance);
         if (autoFrame) {
             if (!scaleSpecified)
-                fprintf(out, "scale = %.12g\n", avgScale);
-            fprintf(out, "translate = %.12g, %.12g\n", translate.x, translate.y);
+                fprintf(metricsFile, "scale = %.12g\n", avgScale);
+            fprintf(metricsFile, "translate = %.12g, %.12g\n", translate.x, translate.y);
         }
         if (rangeMode == RANGE_PX)
-            fprintf(out, "range = %.12g\n", range);
+            fprintf(metricsFile, "range = %.12g\n", range);
         if (mode == METRICS && outputSpecified)
-            fclose(out);
+            fclose(metricsFile);
     }
 
     // Compute output
+    if (mode == MULTI || mode == MULTI_AND_TRUE) {
+        if (!skipColoring)
+            edgeColoring(shape, angleThreshold, coloringSeed);
+        if (edgeAssignment)
+            parseColoring(shape, edgeAssignment);
+    }
+    EdgeGrid edgeGrid(shape);
+    Executor *executor = jobExecutor;
+#ifdef MSDFGEN_USE_CPP11
+    ThreadPool threadPool(threadCount && !jobExecutor ? threadCount : 1);
+    if (threadCount && !jobExecutor)
+        executor = &threadPool;
+#endif
+    pngConfig.executor = executor;
+    const PngEncoderConfig *outputPngConfig = pngConfigSpecified ? &pngConfig : NULL;
+    tiffConfig.executor = executor;
+    const TiffEncoderConfig *outputTiffConfig = tiffConfigSpecified ? &tiffConfig : NULL;
+    GeneratorConfig generatorConfig(overlapSupport);
+    generatorConfig.edgeGrid = &edgeGrid;
+    generatorConfig.narrowBand = narrowBand;
+    generatorConfig.interpolationTolerance = interpolationTolerance/max(scale.x, scale.y);
+    generatorConfig.cubicTolerance = cubicTolerance/max(scale.x, scale.y);
+    generatorConfig.singlePrecision = singlePrecision;
+    generatorConfig.traversal = traversal;
+    generatorConfig.executor = executor;
+    MSDFGeneratorConfig msdfGeneratorConfig(overlapSupport, errorCorrectionThreshold);
+    msdfGeneratorConfig.edgeGrid = &edgeGrid;
+    msdfGeneratorConfig.narrowBand = narrowBand;
+    msdfGeneratorConfig.interpolationTolerance = generatorConfig.interpolationTolerance;
+    msdfGeneratorConfig.cubicTolerance = generatorConfig.cubicTolerance;
+    msdfGeneratorConfig.singlePrecision = singlePrecision;
+    msdfGeneratorConfig.traversal = traversal;
+    msdfGeneratorConfig.executor = executor;
+    if (orientation == GUESS) {
+        // Get sign of signed distance outside bounds
+        Point2 p(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
+        double distance = SimpleTrueShapeDistanceFinder::oneShotDistance(shape, p);
+        orientation = distance <= 0 ? KEEP : REVERSE;
+    }
+    if (shapeExport) {
+        FILE *file = fopen(shapeExport, "w");
+        if (file) {
+            writeShapeDescription(file, shape);
+            fclose(file);
+        } else
+            fprintf(out, "Failed to write shape export file.\n");
+    }
+
+    // Unless the whole distance field is needed after it has been generated, it is written to the output row by row as it is being generated
+    if (mode != METRICS) {
+        const char *error = resolveFormat(output, format);
+        if (error)
+            ABORT(error);
+    }
+    // The scanline pass can only be performed by the generator if the orientation is not reversed before it
+    if (!legacyMode && !(scanlinePass && orientation == REVERSE) && !estimateError && !testRender && !testRenderMulti && isRowOutputFormat(output, format) && !(outputPngConfig && format == PNG) && !(outputTiffConfig && format == TIFF)) {
+        generatorConfig.scanlinePass = scanlinePass;
+        generatorConfig.fillRule = fillRule;
+        msdfGeneratorConfig.scanlinePass = scanlinePass;
+        msdfGeneratorConfig.fillRule = fillRule;
+        const char *error = NULL;
+        switch (mode) {
+            case SINGLE:
+                error = generateOutputRows<1, GeneratorConfig>(&generateSDF, output, format, width, height, shape, range, scale, translate, generatorConfig, orientation == REVERSE, outputDistanceShift, out);
+                break;
+            case PSEUDO:
+                error = generateOutputRows<1, GeneratorConfig>(&generatePseudoSDF, output, format, width, height, shape, range, scale, translate, generatorConfig, orientation == REVERSE, outputDistanceShift, out);
+                break;
+            case MULTI:
+                error = generateOutputRows<3, MSDFGeneratorConfig>(&generateMSDF, output, format, width, height, shape, range, scale, translate, msdfGeneratorConfig, orientation == REVERSE, outputDistanceShift, out);
+                break;
+            case MULTI_AND_TRUE:
+                error = generateOutputRows<4, MSDFGeneratorConfig>(&generateMTSDF, output, format, width, height, shape, range, scale, translate, msdfGeneratorConfig, orientation == REVERSE, outputDistanceShift, out);
+                break;
+            default:;
+        }
+        if (error)
+            ABORT(error);
+        return 0;
+    }
+
     Bitmap<float, 1> sdf;
     Bitmap<float, 3> msdf;
     Bitmap<float, 4> mtsdf;
@@ -888,7 +1495,7 @@ int main(int argc, const char * const *argv) {
             if (legacyMode)
                 generateSDF_legacy(sdf, shape, range, scale, translate);
             else
-                generateSDF(sdf, shape, range, scale, translate, overlapSupport);
+                generateSDF(sdf, shape, range, scale, translate, generatorConfig);
             break;
         }
         case PSEUDO: {
@@ -896,42 +1503,28 @@ int main(int argc, const char * const *argv) {
             if (legacyMode)
                 generatePseudoSDF_legacy(sdf, shape, range, scale, translate);
             else
-                generatePseudoSDF(sdf, shape, range, scale, translate, overlapSupport);
+                generatePseudoSDF(sdf, shape, range, scale, translate, generatorConfig);
             break;
         }
         case MULTI: {
-            if (!skipColoring)
-                edgeColoring(shape, angleThreshold, coloringSeed);
-            if (edgeAssignment)
-                parseColoring(shape, edgeAssignment);
             msdf = Bitmap<float, 3>(width, height);
             if (legacyMode)
                 generateMSDF_legacy(msdf, shape, range, scale, translate, scanlinePass ? 0 : errorCorrectionThreshold);
             else
-                generateMSDF(msdf, shape, range, scale, translate, errorCorrectionThreshold, overlapSupport);
+                generateMSDF(msdf, shape, range, scale, translate, msdfGeneratorConfig);
             break;
         }
         case MULTI_AND_TRUE: {
-            if (!skipColoring)
-                edgeColoring(shape, angleThreshold, coloringSeed);
-            if (edgeAssignment)
-                parseColoring(shape, edgeAssignment);
             mtsdf = Bitmap<float, 4>(width, height);
             if (legacyMode)
                 generateMTSDF_legacy(mtsdf, shape, range, scale, translate, scanlinePass ? 0 : errorCorrectionThreshold);
             else
-                generateMTSDF(mtsdf, shape, range, scale, translate, errorCorrectionThreshold, overlapSupport);
+                generateMTSDF(mtsdf, shape, range, scale, translate, msdfGeneratorConfig);
             break;
         }
         default:;
     }
 
-    if (orientation == GUESS) {
-        // Get sign of signed distance outside bounds
-        Point2 p(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
-        double distance = SimpleTrueShapeDistanceFinder::oneShotDistance(shape, p);
-        orientation = distance <= 0 ? KEEP : REVERSE;
-    }
     if (orientation == REVERSE) {
         switch (mode) {
             case SINGLE:
@@ -951,17 +1544,17 @@ int main(int argc, const char * const *argv) {
         switch (mode) {
             case SINGLE:
             case PSEUDO:
-                distanceSignCorrection(sdf, shape, scale, translate, fillRule);
+                distanceSignCorrection(sdf, shape, scale, translate, fillRule, executor);
                 break;
             case MULTI:
-                distanceSignCorrection(msdf, shape, scale, translate, fillRule);
+                distanceSignCorrection(msdf, shape, scale, translate, fillRule, executor);
                 if (errorCorrectionThreshold > 0)
-                    msdfErrorCorrection(msdf, errorCorrectionThreshold/(scale*range));
+                    msdfErrorCorrection(msdf, errorCorrectionThreshold/(scale*range), executor);
                 break;
             case MULTI_AND_TRUE:
-                distanceSignCorrection(mtsdf, shape, scale, translate, fillRule);
+                distanceSignCorrection(mtsdf, shape, scale, translate, fillRule, executor);
                 if (errorCorrectionThreshold > 0)
-                    msdfErrorCorrection(mtsdf, errorCorrectionThreshold/(scale*range));
+                    msdfErrorCorrection(mtsdf, errorCorrectionThreshold/(scale*range), executor);
                 break;
             default:;
         }
@@ -989,83 +1582,84 @@ int main(int argc, const char * const *argv) {
     }
 
     // Save output
-    if (shapeExport) {
-        FILE *file = fopen(shapeExport, "w");
-        if (file) {
-            writeShapeDescription(file, shape);
-            fclose(file);
-        } else
-            puts("Failed to write shape export file.");
-    }
     const char *error = NULL;
     switch (mode) {
         case SINGLE:
         case PSEUDO:
-            error = writeOutput<1>(sdf, output, format);
+            error = writeOutput<1>(sdf, output, format, outputPngConfig, outputTiffConfig, out);
             if (error)
                 ABORT(error);
             if (is8bitFormat(format) && (testRenderMulti || testRender || estimateError))
                 simulate8bit(sdf);
             if (estimateError) {
-                double sdfError = estimateSDFError(sdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                double sdfError = estimateSDFError(sdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule, errorLimit, executor);
+                if (errorLimit > 0 && sdfError > errorLimit)
+                    fprintf(out, "SDF error > %e\n", sdfError);
+                else
+                    fprintf(out, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
-                Bitmap<float, 3> render(testWidthM, testHeightM);
-                renderSDF(render, sdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRenderMulti))
-                    puts("Failed to write test render file.");
+                Bitmap<byte, 3> render(testWidthM, testHeightM);
+                renderSDF(render, sdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRenderMulti, outputPngConfig))
+                    fprintf(out, "Failed to write test render file.\n");
             }
             if (testRender) {
-                Bitmap<float, 1> render(testWidth, testHeight);
-                renderSDF(render, sdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRender))
-                    puts("Failed to write test render file.");
+                Bitmap<byte, 1> render(testWidth, testHeight);
+                renderSDF(render, sdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRender, outputPngConfig))
+                    fprintf(out, "Failed to write test render file.\n");
             }
             break;
         case MULTI:
-            error = writeOutput<3>(msdf, output, format);
+            error = writeOutput<3>(msdf, output, format, outputPngConfig, outputTiffConfig, out);
             if (error)
                 ABORT(error);
             if (is8bitFormat(format) && (testRenderMulti || testRender || estimateError))
                 simulate8bit(msdf);
             if (estimateError) {
-                double sdfError = estimateSDFError(msdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                double sdfError = estimateSDFError(msdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule, errorLimit, executor);
+                if (errorLimit > 0 && sdfError > errorLimit)
+                    fprintf(out, "SDF error > %e\n", sdfError);
+                else
+                    fprintf(out, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
-                Bitmap<float, 3> render(testWidthM, testHeightM);
-                renderSDF(render, msdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRenderMulti))
-                    puts("Failed to write test render file.");
+                Bitmap<byte, 3> render(testWidthM, testHeightM);
+                renderSDF(render, msdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRenderMulti, outputPngConfig))
+                    fprintf(out, "Failed to write test render file.\n");
             }
             if (testRender) {
-                Bitmap<float, 1> render(testWidth, testHeight);
-                renderSDF(render, msdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRender))
+                Bitmap<byte, 1> render(testWidth, testHeight);
+                renderSDF(render, msdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRender, outputPngConfig))
                     ABORT("Failed to write test render file.");
             }
             break;
         case MULTI_AND_TRUE:
-            error = writeOutput<4>(mtsdf, output, format);
+            error = writeOutput<4>(mtsdf, output, format, outputPngConfig, outputTiffConfig, out);
             if (error)
                 ABORT(error);
             if (is8bitFormat(format) && (testRenderMulti || testRender || estimateError))
                 simulate8bit(mtsdf);
             if (estimateError) {
-                double sdfError = estimateSDFError(mtsdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                double sdfError = estimateSDFError(mtsdf, shape, scale, translate, SDF_ERROR_ESTIMATE_PRECISION, fillRule, errorLimit, executor);
+                if (errorLimit > 0 && sdfError > errorLimit)
+                    fprintf(out, "SDF error > %e\n", sdfError);
+                else
+                    fprintf(out, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
-                Bitmap<float, 4> render(testWidthM, testHeightM);
-                renderSDF(render, mtsdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRenderMulti))
-                    puts("Failed to write test render file.");
+                Bitmap<byte, 4> render(testWidthM, testHeightM);
+                renderSDF(render, mtsdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRenderMulti, outputPngConfig))
+                    fprintf(out, "Failed to write test render file.\n");
             }
             if (testRender) {
-                Bitmap<float, 1> render(testWidth, testHeight);
-                renderSDF(render, mtsdf, avgScale*range, .5f+outputDistanceShift);
-                if (!savePng(render, testRender))
+                Bitmap<byte, 1> render(testWidth, testHeight);
+                renderSDF(render, mtsdf, avgScale*range, .5f+outputDistanceShift, executor);
+                if (!savePngOutput(render, testRender, outputPngConfig))
                     ABORT("Failed to write test render file.");
             }
             break;
@@ -1075,4 +1669,655 @@ int main(int argc, const char * const *argv) {
     return 0;
 }
 
+static bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/// Reads a line of the file without the line break. Returns false at the end of the file.
+static bool readLine(std::string &line, FILE *file) {
+    char buffer[256];
+    line.clear();
+    while (fgets(buffer, sizeof(buffer), file)) {
+        line += buffer;
+        if (line[line.size()-1] == '\n') {
+            line.erase(line.size()-1);
+            return true;
+        }
+    }
+    return !line.empty();
+}
+
+/// Splits a line of a batch file into arguments separated by whitespace. Double quotes, which are removed, may enclose whitespace within an argument.
+static void splitArguments(std::vector<std::string> &args, const char *line) {
+    args.clear();
+    while (*line) {
+        if (isWhitespace(*line)) {
+            ++line;
+            continue;
+        }
+        std::string arg;
+        for (bool quoted = false; *line && (quoted || !isWhitespace(*line)); ++line) {
+            if (*line == '"')
+                quoted = !quoted;
+            else
+                arg.push_back(*line);
+        }
+        args.push_back(arg);
+    }
+}
+
+/// A line of a batch file, or a glyph of a charset, and the result of running it.
+struct BatchJob {
+    int lineNumber;
+    std::vector<std::string> args;
+    /// A temporary file which receives the messages of the job, so that they can be printed in the order of the jobs.
+    FILE *out;
+    int result;
+    JobMetrics metrics;
+};
+
+/// Appends the contents of the file src from its beginning to dst.
+static bool appendFile(FILE *dst, FILE *src) {
+    char buffer[4096];
+    rewind(src);
+    for (size_t length; (length = fread(buffer, 1, sizeof(buffer), src)) > 0;)
+        if (fwrite(buffer, 1, length, dst) != length)
+            return false;
+    return !ferror(src);
+}
+
+/// Runs the jobs of a batch with the common arguments preceding the arguments of each job.
+class BatchRunner {
+
+public:
+    BatchRunner(std::vector<BatchJob> &jobs, const std::vector<const char *> &commonArgs, FontCache &fontCache) : jobs(jobs), commonArgs(commonArgs), fontCache(fontCache) { }
+
+    void operator()(int index, int) {
+        BatchJob &job = jobs[index];
+        std::vector<const char *> argv(commonArgs);
+        for (std::vector<std::string>::const_iterator arg = job.args.begin(); arg != job.args.end(); ++arg)
+            argv.push_back(arg->c_str());
+        job.out = tmpfile();
+        // If no temporary file can be created, the messages are printed right away
+        // The jobs of a batch already run in parallel with each other
+        job.result = runJob((int) argv.size(), &argv[0], job.out ? job.out : stdout, fontCache, &SerialExecutor::instance(), &job.metrics);
+    }
+
+private:
+    std::vector<BatchJob> &jobs;
+    const std::vector<const char *> &commonArgs;
+    FontCache &fontCache;
+
+};
+
+/// Runs the jobs listed in the file, or the standard input if filename is "-", one per line with the same arguments as the command line. Lines starting with # are skipped.
+/// The jobs are read in groups, which end with an empty line or the end of the file, and run in parallel on threadCount threads (all hardware threads if zero) if available.
+/// Once a group is finished, the messages of each job are printed followed by a line with its status.
+static int runBatch(const char *filename, const std::vector<const char *> &commonArgs, unsigned threadCount) {
+    FILE *file = strcmp(filename, "-") ? fopen(filename, "r") : stdin;
+    if (!file) {
+        puts("Failed to open batch file.");
+        return 1;
+    }
+#ifdef MSDFGEN_USE_CPP11
+    ThreadPool threadPool(threadCount);
+    Executor *executor = &threadPool;
+#else
+    Executor *executor = &SerialExecutor::instance();
+#endif
+    FontCache fontCache;
+    std::vector<BatchJob> jobs;
+    std::string line;
+    int lineNumber = 0;
+    bool success = true;
+    for (bool more = true; more;) {
+        bool endOfGroup = !(more = readLine(line, file));
+        if (more) {
+            BatchJob job;
+            job.lineNumber = ++lineNumber;
+            job.out = NULL;
+            job.result = 0;
+            splitArguments(job.args, line.c_str());
+            if (job.args.empty())
+                endOfGroup = true;
+            else if (*job.args[0].c_str() != '#')
+                jobs.push_back(job);
+        }
+        if (jobs.empty() || !(endOfGroup || jobs.size() >= BATCH_GROUP_SIZE))
+            continue;
+        BatchRunner runner(jobs, commonArgs, fontCache);
+        parallelFor(executor, (int) jobs.size(), runner);
+        for (std::vector<BatchJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+            if (job->out) {
+                appendFile(stdout, job->out);
+                fclose(job->out);
+            }
+            printf("job %d: %s\n", job->lineNumber, job->result ? "FAILED" : "OK");
+            success &= !job->result;
+        }
+        fflush(stdout);
+        jobs.clear();
+    }
+    if (file != stdin)
+        fclose(file);
+    return success ? 0 : 1;
+}
+
+/// Generates the glyphs of the charset from the font file in parallel, each by a job with the common arguments followed by the glyph.
+/// Their outputs are written into the directory if the output name ends with a slash, or one after another into the single output file otherwise.
+/// The manifest printed to out contains a paragraph for each glyph with its file name or position in the output file, its metrics, and the messages of its job.
+static int runCharset(const char *fontFilename, const std::vector<CharsetEntry> &charset, const char *output, Format format, const std::vector<const char *> &commonArgs, unsigned threadCount, FILE *out) {
+    size_t outputLength = strlen(output);
+    bool directory = outputLength > 0 && (output[outputLength-1] == '/' || output[outputLength-1] == '\\');
+    if (directory && format == AUTO)
+        format = PNG;
+    if (const char *error = resolveFormat(output, format)) {
+        fprintf(out, "%s\n", error);
+        return 1;
+    }
+    FILE *container = NULL;
+    if (!directory && !(container = fopen(output, "wb"))) {
+        fputs("Failed to write output file.\n", out);
+        return 1;
+    }
+#ifdef MSDFGEN_USE_CPP11
+    ThreadPool threadPool(threadCount);
+    Executor *executor = &threadPool;
+#else
+    Executor *executor = &SerialExecutor::instance();
+#endif
+    FontCache fontCache;
+    std::vector<BatchJob> jobs;
+    long offset = 0;
+    bool success = true;
+    for (size_t groupStart = 0; groupStart < charset.size(); groupStart += BATCH_GROUP_SIZE) {
+        jobs.resize(min(charset.size()-groupStart, (size_t) BATCH_GROUP_SIZE));
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const CharsetEntry &entry = charset[groupStart+i];
+            char code[16];
+            sprintf(code, entry.isGlyphIndex ? "g%u" : "%u", entry.code);
+            // The glyphs of a single output file are first written into temporary files next to it
+            std::string filename(output);
+            if (directory)
+                filename += std::string(code)+"."+formatExtension(format);
+            else
+                filename += "."+std::string(code)+".tmp";
+            BatchJob &job = jobs[i];
+            job.lineNumber = (int) (groupStart+i+1);
+            job.args.clear();
+            job.args.push_back("-font");
+            job.args.push_back(fontFilename);
+            job.args.push_back(code);
+            job.args.push_back("-format");
+            job.args.push_back(formatName(format));
+            job.args.push_back("-o");
+            job.args.push_back(filename);
+            job.out = NULL;
+            job.result = 0;
+        }
+        BatchRunner runner(jobs, commonArgs, fontCache);
+        parallelFor(executor, (int) jobs.size(), runner);
+        for (std::vector<BatchJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+            const char *filename = job->args[6].c_str();
+            fprintf(out, "glyph = %s\n", job->args[2].c_str());
+            if (!job->result) {
+                if (container) {
+                    FILE *file = fopen(filename, "rb");
+                    if (file && appendFile(container, file)) {
+                        long end = ftell(container);
+                        fprintf(out, "offset = %ld\nsize = %ld\n", offset, end-offset);
+                        offset = end;
+                    } else {
+                        fputs("Failed to write output file.\n", out);
+                        job->result = 1;
+                    }
+                    if (file)
+                        fclose(file);
+                } else
+                    fprintf(out, "file = %s\n", filename);
+            }
+            if (!job->result) {
+                const JobMetrics &metrics = job->metrics;
+                if (metrics.bounds.r >= metrics.bounds.l && metrics.bounds.t >= metrics.bounds.b)
+                    fprintf(out, "bounds = %.12g, %.12g, %.12g, %.12g\n", metrics.bounds.l, metrics.bounds.b, metrics.bounds.r, metrics.bounds.t);
+                fprintf(out, "advance = %.12g\n", metrics.advance);
+                if (metrics.scale.x == metrics.scale.y)
+                    fprintf(out, "scale = %.12g\n", metrics.scale.x);
+                else
+                    fprintf(out, "scale = %.12g, %.12g\n", metrics.scale.x, metrics.scale.y);
+                fprintf(out, "translate = %.12g, %.12g\n", metrics.translate.x, metrics.translate.y);
+                fprintf(out, "range = %.12g\n", metrics.range);
+            }
+            if (job->out) {
+                appendFile(out, job->out);
+                fclose(job->out);
+            }
+            if (container)
+                remove(filename);
+            fputc('\n', out);
+            success &= !job->result;
+        }
+        fflush(out);
+    }
+    if (container && fclose(container)) {
+        fputs("Failed to write output file.\n", out);
+        return 1;
+    }
+    return success ? 0 : 1;
+}
+
+#ifdef MSDFGEN_SERVER_MODE
+
+static volatile sig_atomic_t serverStopped = 0;
+/// The write end of the pipe which wakes up the server's poll loop.
+static int serverWakeFd = -1;
+
+static void wakeServer() {
+    ssize_t written = write(serverWakeFd, "", 1);
+    (void) written;
+}
+
+static void stopServer(int) {
+    serverStopped = 1;
+    wakeServer();
+}
+
+/// The output of a request to the server, kept in a sealed memory file so that it can be passed to any number of clients.
+struct ServerResult {
+    int fd;
+    size_t size;
+    std::string messages;
+    unsigned long long lastUse;
+};
+
+/// A connection to the server. Its requests are answered in order, so the following ones are not read while one of its jobs is running.
+struct ServerClient {
+    int fd;
+    std::string input;
+    bool busy;
+};
+
+/// A request whose job is running on a thread of its own.
+struct ServerJob {
+    std::list<ServerClient>::iterator client;
+    std::vector<std::string> args;
+    std::string key;
+    bool cacheable;
+    ServerResult result;
+    std::thread thread;
+    bool finished;
+};
+
+/// Sends the response text to the client with the file descriptor fd attached, unless it is negative.
+static bool sendResponse(int client, const std::string &response, int fd) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec data;
+    struct msghdr message;
+    memset(control, 0, sizeof(control));
+    memset(&message, 0, sizeof(message));
+    data.iov_base = const_cast<char *>(response.data());
+    data.iov_len = response.size();
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    if (fd >= 0) {
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(header), &fd, sizeof(int));
+    }
+    // The file descriptor arrives with the first part of the response
+    for (size_t sent = 0; sent < response.size();) {
+        ssize_t length = sendmsg(client, &message, MSG_NOSIGNAL);
+        if (length < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        sent += length;
+        data.iov_base = const_cast<char *>(response.data()+sent);
+        data.iov_len = response.size()-sent;
+        message.msg_control = NULL;
+        message.msg_controllen = 0;
+    }
+    return true;
+}
+
+/// Runs the jobs requested by the clients of a Unix domain socket, one line of arguments at a time, with the common arguments preceding them.
+/// Each job runs on a thread of its own, so that the requests of other clients are served meanwhile, and their parallel stages share the thread pool.
+/// The fonts, the thread pool, and the most recently used results are kept between requests.
+/// A result is reused only for the same arguments and unmodified input files, and never for jobs which write files other than their output.
+class Server {
+
+public:
+    Server(const std::vector<const char *> &commonArgs, unsigned threadCount) : commonArgs(commonArgs), threadPool(threadCount), cacheSize(0), useCounter(0) { }
+
+    ~Server() {
+        for (std::map<std::string, ServerResult>::iterator result = cache.begin(); result != cache.end(); ++result)
+            close(result->second.fd);
+    }
+
+    /// Serves the clients of the socket until the process is interrupted or terminated. Returns an error message on failure.
+    const char * run(const char *socketPath) {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (strlen(socketPath) >= sizeof(address.sun_path))
+            return "Server socket path is too long.";
+        strcpy(address.sun_path, socketPath);
+        int listener = socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+        if (listener < 0)
+            return "Failed to create server socket.";
+        // Only a stale socket left by a previous server may be replaced
+        struct stat info;
+        if (!lstat(socketPath, &info)) {
+            if (!S_ISSOCK(info.st_mode) || unlink(socketPath)) {
+                close(listener);
+                return "Server socket path is in use.";
+            }
+        } else if (errno != ENOENT) {
+            close(listener);
+            return "Server socket path is in use.";
+        }
+        if (bind(listener, (struct sockaddr *) &address, sizeof(address)) || listen(listener, SOMAXCONN)) {
+            close(listener);
+            return "Failed to listen on server socket.";
+        }
+        int wakePipe[2];
+        if (pipe2(wakePipe, O_CLOEXEC|O_NONBLOCK)) {
+            close(listener);
+            unlink(socketPath);
+            return "Failed to create server pipe.";
+        }
+        serverWakeFd = wakePipe[1];
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        printf("Listening on %s\n", socketPath);
+        fflush(stdout);
+
+        std::vector<std::list<ServerClient>::iterator> polled;
+        std::vector<struct pollfd> events;
+        while (!serverStopped) {
+            // Busy clients are not polled until their job finishes
+            polled.clear();
+            for (std::list<ServerClient>::iterator client = clients.begin(); client != clients.end(); ++client)
+                if (!client->busy)
+                    polled.push_back(client);
+            events.resize(polled.size()+2);
+            for (size_t i = 0; i < events.size(); ++i) {
+                events[i].fd = i == 0 ? listener : i == 1 ? wakePipe[0] : polled[i-2]->fd;
+                events[i].events = POLLIN;
+                events[i].revents = 0;
+            }
+            if (poll(&events[0], events.size(), -1) < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (events[1].revents) {
+                char buffer[64];
+                while (read(wakePipe[0], buffer, sizeof(buffer)) > 0);
+                finishJobs();
+            }
+            for (size_t i = 0; i < polled.size(); ++i) {
+                if (!events[i+2].revents)
+                    continue;
+                std::list<ServerClient>::iterator client = polled[i];
+                char buffer[4096];
+                ssize_t length = read(client->fd, buffer, sizeof(buffer));
+                if (length < 0 && errno == EINTR)
+                    continue;
+                bool connected = length > 0;
+                if (connected) {
+                    client->input.append(buffer, length);
+                    connected = serveRequests(client);
+                }
+                if (!connected) {
+                    close(client->fd);
+                    clients.erase(client);
+                }
+            }
+            if (events[0].revents) {
+                int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+                if (fd >= 0) {
+                    ServerClient client;
+                    client.fd = fd;
+                    client.busy = false;
+                    clients.push_back(client);
+                }
+            }
+        }
+
+        // The running jobs are finished before the server stops
+        for (std::list<ServerJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+            job->thread.join();
+            if (job->result.fd >= 0)
+                close(job->result.fd);
+        }
+        jobs.clear();
+        for (std::list<ServerClient>::iterator client = clients.begin(); client != clients.end(); ++client)
+            close(client->fd);
+        clients.clear();
+        serverWakeFd = -1;
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+        close(listener);
+        unlink(socketPath);
+        return NULL;
+    }
+
+private:
+    std::vector<const char *> commonArgs;
+    ThreadPool threadPool;
+    FontCache fontCache;
+    std::map<std::string, std::string> fontIdentities;
+    std::map<std::string, ServerResult> cache;
+    size_t cacheSize;
+    unsigned long long useCounter;
+    std::list<ServerClient> clients;
+    std::list<ServerJob> jobs;
+    std::mutex jobMutex;
+
+    /// Answers the request lines received from the client until one of them starts a job, with the result of a previous request if it can be reused.
+    /// Returns false if the client cannot be reached or its request is too long.
+    bool serveRequests(std::list<ServerClient>::iterator client) {
+        for (size_t end; !client->busy && (end = client->input.find('\n')) != std::string::npos;) {
+            std::vector<std::string> args;
+            splitArguments(args, client->input.substr(0, end).c_str());
+            client->input.erase(0, end+1);
+            if (args.empty())
+                continue;
+            std::string key;
+            for (std::vector<std::string>::const_iterator arg = args.begin(); arg != args.end(); ++arg)
+                key.append(arg->c_str(), arg->size()+1);
+            bool cacheable = identifyInputs(key, args);
+            std::map<std::string, ServerResult>::iterator cached = cache.find(key);
+            if (cacheable && cached != cache.end()) {
+                cached->second.lastUse = ++useCounter;
+                if (!respond(client->fd, cached->second))
+                    return false;
+                continue;
+            }
+            jobs.push_back(ServerJob());
+            ServerJob &job = jobs.back();
+            job.client = client;
+            job.args.swap(args);
+            job.key.swap(key);
+            job.cacheable = cacheable;
+            job.finished = false;
+            client->busy = true;
+            job.thread = std::thread(&Server::runJobThread, this, &job);
+        }
+        return client->busy || client->input.size() <= SERVER_REQUEST_LIMIT;
+    }
+
+    /// Runs the job and wakes up the poll loop to respond once it has finished.
+    void runJobThread(ServerJob *job) {
+        generate(job->result, job->args);
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            job->finished = true;
+        }
+        wakeServer();
+    }
+
+    /// Responds to the clients whose jobs have finished and keeps their results, then serves their following requests.
+    void finishJobs() {
+        for (std::list<ServerJob>::iterator job = jobs.begin(); job != jobs.end();) {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                if (!job->finished) {
+                    ++job;
+                    continue;
+                }
+            }
+            job->thread.join();
+            std::list<ServerClient>::iterator client = job->client;
+            client->busy = false;
+            job->result.lastUse = ++useCounter;
+            bool connected = respond(client->fd, job->result);
+            if (job->result.fd >= 0 && !(job->cacheable && cacheResult(job->key, job->result)))
+                close(job->result.fd);
+            job = jobs.erase(job);
+            if (!(connected && serveRequests(client))) {
+                close(client->fd);
+                clients.erase(client);
+            }
+        }
+    }
+
+    /// Responds with the messages of the job followed by "OK <size>" with the memory file attached, or "FAILED". Returns false if the client cannot be reached.
+    bool respond(int client, const ServerResult &result) {
+        std::string response(result.messages);
+        char status[32];
+        if (result.fd >= 0)
+            sprintf(status, "OK %llu\n", (unsigned long long) result.size);
+        else
+            strcpy(status, "FAILED\n");
+        response += status;
+        // Each response gets its own read-only open file description, so that the clients do not share its file offset
+        int fd = -1;
+        if (result.fd >= 0) {
+            char path[32];
+            sprintf(path, "/proc/self/fd/%d", result.fd);
+            fd = ::open(path, O_RDONLY|O_CLOEXEC);
+        }
+        bool sent = sendResponse(client, response, fd >= 0 ? fd : result.fd);
+        if (fd >= 0)
+            close(fd);
+        return sent;
+    }
+
+    /// Appends the identities of the input files of the job to its cache key, and unloads the fonts which have been modified since they were loaded.
+    /// Returns false if the result may not be cached, because an input file is missing or the job writes other files.
+    bool identifyInputs(std::string &key, const std::vector<std::string> &args) {
+        std::vector<const char *> argv(commonArgs);
+        for (std::vector<std::string>::const_iterator arg = args.begin(); arg != args.end(); ++arg)
+            argv.push_back(arg->c_str());
+        bool cacheable = true;
+        for (size_t i = 0; i < argv.size(); ++i) {
+            const char *arg = argv[i];
+            if (!strcmp(arg, "-exportshape") || !strcmp(arg, "-testrender") || !strcmp(arg, "-testrendermulti"))
+                cacheable = false;
+            else if ((!strcmp(arg, "-font") || !strcmp(arg, "-svg") || !strcmp(arg, "-shapedesc")) && i+1 < argv.size()) {
+                const char *filename = argv[++i];
+                struct stat info;
+                if (stat(filename, &info)) {
+                    cacheable = false;
+                    continue;
+                }
+                char identity[128];
+                sprintf(identity, "%llu:%llu:%lld.%09ld:%lld", (unsigned long long) info.st_dev, (unsigned long long) info.st_ino, (long long) info.st_mtim.tv_sec, (long) info.st_mtim.tv_nsec, (long long) info.st_size);
+                key.append(identity, strlen(identity)+1);
+                if (!strcmp(arg, "-font")) {
+                    std::string &fontIdentity = fontIdentities[filename];
+                    if (fontIdentity != identity) {
+                        fontCache.unloadFont(filename);
+                        fontIdentity = identity;
+                    }
+                }
+            }
+        }
+        return cacheable;
+    }
+
+    /// Runs the job with its output written into a new memory file, which is sealed against modification if it succeeds.
+    void generate(ServerResult &result, const std::vector<std::string> &args) {
+        result.size = 0;
+        result.lastUse = 0;
+        result.fd = memfd_create("msdfgen-output", MFD_CLOEXEC|MFD_ALLOW_SEALING);
+        if (result.fd < 0) {
+            result.messages = "Failed to create output memory file.\n";
+            return;
+        }
+        char outputPath[32];
+        sprintf(outputPath, "/proc/self/fd/%d", result.fd);
+        // The output format defaults to raw floating-point values, and the output file is always the memory file
+        std::vector<const char *> argv(commonArgs);
+        argv.push_back("-format");
+        argv.push_back("binfloat");
+        for (std::vector<std::string>::const_iterator arg = args.begin(); arg != args.end(); ++arg)
+            argv.push_back(arg->c_str());
+        argv.push_back("-o");
+        argv.push_back(outputPath);
+        FILE *out = tmpfile();
+        int status = runJob((int) argv.size(), &argv[0], out ? out : stdout, fontCache, &threadPool);
+        if (out) {
+            char buffer[4096];
+            rewind(out);
+            for (size_t length; (length = fread(buffer, 1, sizeof(buffer), out)) > 0;)
+                result.messages.append(buffer, length);
+            fclose(out);
+        }
+        struct stat info;
+        if (!status && !fstat(result.fd, &info) && !fcntl(result.fd, F_ADD_SEALS, F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_WRITE|F_SEAL_SEAL)) {
+            result.size = (size_t) info.st_size;
+            return;
+        }
+        close(result.fd);
+        result.fd = -1;
+    }
+
+    /// Keeps the result for repeated requests, evicting the least recently used ones if they would exceed SERVER_CACHE_SIZE. Returns false if it is too large or an equal result is already kept.
+    bool cacheResult(const std::string &key, const ServerResult &result) {
+        if (result.size > SERVER_CACHE_SIZE || cache.find(key) != cache.end())
+            return false;
+        while (cacheSize+result.size > SERVER_CACHE_SIZE) {
+            std::map<std::string, ServerResult>::iterator oldest = cache.begin();
+            for (std::map<std::string, ServerResult>::iterator cached = cache.begin(); cached != cache.end(); ++cached)
+                if (cached->second.lastUse < oldest->second.lastUse)
+                    oldest = cached;
+            close(oldest->second.fd);
+            cacheSize -= oldest->second.size;
+            cache.erase(oldest);
+        }
+        cache.insert(std::make_pair(key, result));
+        cacheSize += result.size;
+        return true;
+    }
+
+    Server(const Server &);
+    Server &operator=(const Server &);
+
+};
+
+/// Runs a server for jobs on the Unix domain socket at socketPath, using a pool of threadCount threads (all hardware threads if zero).
+static int runServer(const char *socketPath, const std::vector<const char *> &commonArgs, unsigned threadCount) {
+    Server server(commonArgs, threadCount);
+    if (const char *error = server.run(socketPath)) {
+        puts(error);
+        return 1;
+    }
+    return 0;
+}
+
+#endif
+
+int main(int argc, const char * const *argv) {
+    FontCache fontCache;
+    return runJob(argc, argv, stdout, fontCache, NULL);
+}
+
 #endif
@@ -17,10 +17,13 @@
  *   (to aid in parsing input SVG files)
  * - LodePNG by Lode Vandevenne
  *   (to save output PNG images)
+ * - libpng (optional)
+ *   (to save output PNG images row by row)
  *
  */
 
 #include "ext/resolve-shape-geometry.h"
 #include "ext/save-png.h"
+#include "ext/save-compressed-tiff.h"
 #include "ext/import-svg.h"
 #include "ext/import-font.h"
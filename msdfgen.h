@@ -19,11 +19,19 @@
 #include "core/Vector2.h"
 #include "core/Scanline.h"
 #include "core/Shape.h"
+#include "core/ScanlineGenerator.h"
+#include "core/EdgeGrid.h"
+#include "core/CompiledShape.h"
+#include "core/Executor.h"
+#include "core/ThreadPool.h"
 #include "core/BitmapRef.hpp"
 #include "core/Bitmap.h"
+#include "core/RowWriter.h"
+#include "core/GeneratorJob.h"
 #include "core/bitmap-interpolation.hpp"
 #include "core/pixel-conversion.hpp"
 #include "core/edge-coloring.h"
+#include "core/generator-config.h"
 #include "core/msdf-error-correction.h"
 #include "core/render-sdf.h"
 #include "core/rasterization.h"
@@ -48,6 +56,43 @@ void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double
 /// Generates a multi-channel signed distance field with true distance in the alpha channel. Edge colors must be assigned first.
 void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true);
 
+// Versions of the previous functions that take their additional parameters in a configuration structure (see generator-config.h)
+void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+
+// Versions of the previous functions that output integer pixels, which are generated without a floating-point copy of the whole distance field
+void generateSDF(const BitmapRef<byte, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generatePseudoSDF(const BitmapRef<byte, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generateMSDF(const BitmapRef<byte, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+void generateMTSDF(const BitmapRef<byte, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+void generateSDF(const BitmapRef<uint16_t, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generatePseudoSDF(const BitmapRef<uint16_t, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+void generateMSDF(const BitmapRef<uint16_t, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+void generateMTSDF(const BitmapRef<uint16_t, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+
+// Versions of the previous functions that generate a distance field of width x height pixels in bands of rows and pass each finished row to writer, so that the whole distance field is never held in memory. Return false if the writer fails.
+bool generateSDF(RowWriter<1> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+bool generatePseudoSDF(RowWriter<1> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const GeneratorConfig &config);
+bool generateMSDF(RowWriter<3> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+bool generateMTSDF(RowWriter<4> &writer, int width, int height, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, const MSDFGeneratorConfig &config);
+
+// Versions of the previous functions that generate a batch of jobs, each with its own shape, output bitmap, range and transformation. Whole jobs are distributed among the threads of the configuration's executor,
+// balanced by their estimated cost, which keeps all threads busy even if the distance fields are too small to be split efficiently. The configuration's edge grid is not used.
+void generateSDF(const GeneratorJob<float, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generatePseudoSDF(const GeneratorJob<float, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generateMSDF(const GeneratorJob<float, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+void generateMTSDF(const GeneratorJob<float, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+void generateSDF(const GeneratorJob<byte, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generatePseudoSDF(const GeneratorJob<byte, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generateMSDF(const GeneratorJob<byte, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+void generateMTSDF(const GeneratorJob<byte, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+void generateSDF(const GeneratorJob<uint16_t, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generatePseudoSDF(const GeneratorJob<uint16_t, 1> *jobs, int jobCount, const GeneratorConfig &config);
+void generateMSDF(const GeneratorJob<uint16_t, 3> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+void generateMTSDF(const GeneratorJob<uint16_t, 4> *jobs, int jobCount, const MSDFGeneratorConfig &config);
+
 // Original simpler versions of the previous functions, which work well under normal circumstances, but cannot deal with overlapping contours.
 void generateSDF_legacy(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
 void generatePseudoSDF_legacy(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+
+# A minimal client of msdfgen -server, which sends one request line and checks the memory file received in response.
+# Usage: server-client.py <socket> "<arguments of the job>" [<output file>]
+
+import array
+import os
+import socket
+import sys
+
+def request(socketPath, line):
+    """Sends the request line and returns the messages of the job, the size reported by OK (None if FAILED), and the received file descriptor."""
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    client.connect(socketPath)
+    client.sendall(line.encode() + b"\n")
+    response = b""
+    fd = None
+    while True:
+        data, ancdata, flags, address = client.recvmsg(4096, socket.CMSG_SPACE(array.array("i").itemsize))
+        for level, type, payload in ancdata:
+            if level == socket.SOL_SOCKET and type == socket.SCM_RIGHTS:
+                fds = array.array("i")
+                fds.frombytes(payload[:len(payload)-len(payload)%fds.itemsize])
+                fd = fds[0]
+        if not data:
+            raise RuntimeError("The server closed the connection.")
+        response += data
+        lines = response.split(b"\n")
+        if len(lines) >= 2 and (lines[-2].startswith(b"OK ") or lines[-2] == b"FAILED"):
+            break
+    client.close()
+    status = lines[-2].decode()
+    messages = b"\n".join(lines[:-2]).decode()
+    size = int(status[3:]) if status.startswith("OK ") else None
+    return messages, size, fd
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: server-client.py <socket> \"<arguments of the job>\" [<output file>]")
+        return 1
+    messages, size, fd = request(sys.argv[1], sys.argv[2])
+    if messages:
+        print(messages)
+    if size is None:
+        print("FAILED")
+        return 1
+    if fd is None:
+        print("No file descriptor received.")
+        return 1
+    actualSize = os.fstat(fd).st_size
+    if actualSize != size:
+        print("The memory file has %d bytes instead of %d." % (actualSize, size))
+        return 1
+    if len(sys.argv) > 3:
+        with open(sys.argv[3], "wb") as output:
+            output.write(os.pread(fd, size, 0) if size else b"")
+    os.close(fd)
+    print("OK %d" % size)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())